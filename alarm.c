@@ -7,19 +7,28 @@
 
 #include "alarm.h"
 
-Alarm Alarm_New(DateTime alarm_time, uint8_t enabled) {
+Alarm Alarm_New(DateTime alarm_time, uint8_t enabled, DateTime_Epoch now, const TimeZone *zone) {
 	AlarmState state = enabled ? ALARM_OFF : ALARM_DISABLED;
-	Alarm alarm = {alarm_time, state, alarm_time};
+	Alarm alarm = {alarm_time, state, 0, 0};
+	Alarm_Schedule(&alarm, now, zone);
 	return alarm;
 }
 
-uint8_t Alarm_CheckTrigger(Alarm *alarm, const DateTime *current_time) {	
-	if (alarm->state == ALARM_OFF && DateTime_TimeEquals(&alarm->time, current_time))
+void Alarm_Schedule(Alarm *alarm, DateTime_Epoch now, const TimeZone *zone) {
+	if (alarm->state == ALARM_OFF) {
+		alarm->rings_at = TimeZone_NextLocalTime(zone, now, DateTime_SecondOfDay(&alarm->time));
+	}
+}
+
+uint8_t Alarm_CheckTrigger(Alarm *alarm, DateTime_Epoch now) {	
+	// Also rings if the second it is due on was not read
+	if (alarm->state == ALARM_OFF && now >= alarm->rings_at)
 	{
-		alarm->state = ALARM_BEEPING;	
+		alarm->state = ALARM_BEEPING;
+		alarm->rang_at = now;
 		return 1;
 	}
-	if (alarm->state == ALARM_SNOOZED && DateTime_TimeEquals(&alarm->snoozed_till, current_time))
+	if (alarm->state == ALARM_SNOOZED && now >= alarm->rings_at)
 	{
 		alarm->state = ALARM_BEEPING;
 		return 1;
@@ -27,17 +36,28 @@ uint8_t Alarm_CheckTrigger(Alarm *alarm, const DateTime *current_time) {
 	return 0;
 }
 
+uint32_t Alarm_SecondsUntil(const Alarm *alarm, DateTime_Epoch now) {
+	switch (alarm->state) {
+		case ALARM_OFF:
+		case ALARM_SNOOZED:
+			return alarm->rings_at > now ? alarm->rings_at - now : 0;
+		default:
+			return ALARM_NOT_SCHEDULED;
+	}
+}
+
 // Snooze the alarm
-void Alarm_Snooze(Alarm *alarm, const DateTime *current_time) {
+void Alarm_Snooze(Alarm *alarm, DateTime_Epoch now) {
 	if (alarm->state == ALARM_BEEPING) {
 		alarm->state = ALARM_SNOOZED;
-		alarm->snoozed_till = DateTime_AddTimeDuration(current_time, 0, ALARM_SNOOZE_MINUTES, 0);
+		alarm->rings_at = now + ALARM_SNOOZE_MINUTES * 60UL;
 	}
 }
 
 // Snooze the alarm
-void Alarm_Off(Alarm *alarm) {
+void Alarm_Off(Alarm *alarm, DateTime_Epoch now, const TimeZone *zone) {
 	if (alarm->state == ALARM_BEEPING) {
 		alarm->state = ALARM_OFF;
+		Alarm_Schedule(alarm, now, zone);
 	}
 }
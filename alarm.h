@@ -9,9 +9,13 @@
 #define ALARM_H
 
 #include "datetime.h"
+#include "timezone.h"
 
 #define ALARM_SNOOZE_MINUTES 10
 
+// Returned by Alarm_SecondsUntil when the alarm is not going to ring
+#define ALARM_NOT_SCHEDULED 0xFFFFFFFF
+
 typedef enum {
 	ALARM_OFF,
 	ALARM_BEEPING,
@@ -19,22 +23,33 @@ typedef enum {
 	ALARM_DISABLED,
 } AlarmState;
 
+// The alarm time is a local time of day. When it rings is kept as an instant (UTC seconds
+// since 2000, like `now` below), so it rings once a day across DST changes: at the
+// first of a repeated time, and when DST starts at the end of a skipped one.
 typedef struct {
 	DateTime time; // only the time part is relevant, not the date
 	AlarmState state;
-	DateTime snoozed_till;	// only the time part is relevant, not the date
+	DateTime_Epoch rings_at;	// when it next rings (ALARM_OFF), or rings again after a snooze (ALARM_SNOOZED)
+	DateTime_Epoch rang_at;		// when it last started ringing, 0 if it has not
 } Alarm;
 
-// Create a new alarm
-Alarm Alarm_New(DateTime alarm_time, uint8_t enabled);
+// Create a new alarm, scheduled after `now` in a time zone if enabled
+Alarm Alarm_New(DateTime alarm_time, uint8_t enabled, DateTime_Epoch now, const TimeZone *zone);
+
+// Check if alarm should be triggered, `now` is the current time in seconds since 2000
+uint8_t Alarm_CheckTrigger(Alarm *alarm, DateTime_Epoch now);
+
+// Schedule an ALARM_OFF alarm again after `now`, once the clock has been set
+void Alarm_Schedule(Alarm *alarm, DateTime_Epoch now, const TimeZone *zone);
 
-// Check if alarm should be triggered
-uint8_t Alarm_CheckTrigger(Alarm *alarm, const DateTime* current_time);
+// Seconds from `now` until the alarm next rings (from snooze if snoozed),
+// or ALARM_NOT_SCHEDULED if it is disabled or already ringing
+uint32_t Alarm_SecondsUntil(const Alarm *alarm, DateTime_Epoch now);
 
-// Snooze the alarm
-void Alarm_Snooze(Alarm *alarm, const DateTime* current_time);
+// Snooze the alarm for ALARM_SNOOZE_MINUTES from `now`
+void Alarm_Snooze(Alarm *alarm, DateTime_Epoch now);
 
 // Turn off the alarm till next day
-void Alarm_Off(Alarm *alarm);
+void Alarm_Off(Alarm *alarm, DateTime_Epoch now, const TimeZone *zone);
 
 #endif // ALARM_H
@@ -7,19 +7,49 @@
 
 #define ASSUMED_YEAR_OFFSET 2000
 
+// The DS3231 keeps UTC, the clock shows the time of this zone (see timezone.h)
+#ifndef ALARM_CLOCK_TIMEZONE
+#define ALARM_CLOCK_TIMEZONE TIMEZONE_US_EASTERN
+#endif
+
+// Backlight schedule: dimmed at night, brightened over the last minutes before the alarm
+#define NIGHT_START_HOUR            22
+#define NIGHT_END_HOUR              7
+#define BACKLIGHT_DIM_FADE_MS       5000
+#define WAKE_RAMP_MINUTES           10
+
+// Set a field being edited from the pot, the display is redrawn only if the value changed
+#define SET_FIELD(clock, field, value) do { \
+	uint16_t set_field_value = (value); \
+	if ((field) != set_field_value) { \
+		(field) = set_field_value; \
+		(clock)->redraw = 1; \
+	} \
+} while (0)
+
 #include "alarmclock.h"
 #include "ds3231.h"
+#include "datetime_ds3231.h"
 #include "lcd_dfr0555.h"
+#include "bigdigits.h"
+#include "backlight.h"
+#include "format.h"
+#include "ui_strings.h"
 #include "util.h"
 #include <stdio.h>
 #include <string.h>
 
 // Private functions
-static uint8_t update_ds3231_time(AlarmClock *clock); // Update ds3231 time to clock->current_time, return 1 if successful
-static void alarm_str(Alarm* alarm, char* buf, size_t len);
+static uint8_t set_local_time(AlarmClock *clock, const DateTime *local); // Set the ds3231 to a local time, return 1 if successful
+static void print_time(const DateTime *time);
+static void update_backlight(AlarmClock *clock);
+static void alarm_str(Alarm* alarm, const TimeZone* zone, char* buf, size_t len);
 static void time_display(AlarmClock *clock);
+static void big_digits_time_display(AlarmClock *clock);
 static void main_settings_display();
 static void set_time_date_selection_display();
+static uint8_t centered_column(const char* line, uint8_t index);
+static uint8_t time_field_column(const char* time_str, TimeField field);
 static void setting_time_display(AlarmClock *clock);
 static void setting_date_display(AlarmClock *clock);
 static void set_alarm_selection_display();
@@ -37,72 +67,123 @@ static void handle_pot_input_setting_alarm_state(AlarmClock *clock, float pot_va
 
 AlarmClock AlarmClock_Init() {
 	
-	uint8_t time_data[7]; 
 	DateTime time;
-	if (ds3231_read(TIME, time_data) == OPERATION_DONE) {
-		DateTime_FromDS3231Array(time_data, &time);
-		print_time_data(time_data);
+	if (DateTime_ReadDS3231(&time) == OPERATION_DONE) {
+		print_time(&time);
 	}
 	else {
-		printf("ERROR: Failed to read initial time from DS3231\n");
-		printf("WARNING: Creating AlarmClock with uninitialized time");
+		printf_P(PSTR("ERROR: Failed to read initial time from DS3231\n"));
+		printf_P(PSTR("WARNING: Creating AlarmClock with uninitialized time"));
 	}
 	
-	AlarmClockTimeSettingMenu time_setting_menu = {time, ALARM_CLOCK_TIME_FIELD_NONE};
+	DateTime_Epoch now = DateTime_ToEpoch(&time);
+	TimeZone zone = TimeZone_New(ALARM_CLOCK_TIMEZONE, now);
+	DateTime local = DateTime_FromEpoch(TimeZone_ToLocal(&zone, now));
+	AlarmClockTimeSettingMenu time_setting_menu = {local, ALARM_CLOCK_TIME_FIELD_NONE};
 	AlarmClockMenu menu = {ALARM_CLOCK_MENU_DISPLAY_TIME, time_setting_menu};
-	Alarm alarm = Alarm_New(time, 0);
-	AlarmClock alarmclock = {time, alarm, menu, 0};
+	Alarm alarm = Alarm_New(local, 0, now, &zone);
+	AlarmClock alarmclock = {local, now, zone, alarm, menu, 0, ALARM_CLOCK_DISPLAY_TEXT, 1};
+	update_backlight(&alarmclock);
 	return alarmclock;
 }
 
 AlarmClock AlarmClock_InitWithTime(DateTime time) {
-	AlarmClockTimeSettingMenu time_setting_menu = {time, ALARM_CLOCK_TIME_FIELD_NONE};
+	DateTime_Epoch now = DateTime_ToEpoch(&time);
+	TimeZone zone = TimeZone_New(ALARM_CLOCK_TIMEZONE, now);
+	DateTime local = DateTime_FromEpoch(TimeZone_ToLocal(&zone, now));
+	AlarmClockTimeSettingMenu time_setting_menu = {local, ALARM_CLOCK_TIME_FIELD_NONE};
 	AlarmClockMenu menu = {ALARM_CLOCK_MENU_DISPLAY_TIME, time_setting_menu};
-	Alarm alarm = Alarm_New(time, 0);
-	AlarmClock alarmclock = {time, alarm, menu, 0};
+	Alarm alarm = Alarm_New(local, 0, now, &zone);
+	AlarmClock alarmclock = {local, now, zone, alarm, menu, 0, ALARM_CLOCK_DISPLAY_TEXT, 1};
 	return alarmclock;
 }
 
 void AlarmClock_FetchTime(AlarmClock* clock) {
 			
 	// Read the time from the ds3231
-	uint8_t time_data[7]; 
 	DateTime new_time;
-	if (ds3231_read(TIME, time_data) == OPERATION_DONE) {	
-		DateTime_FromDS3231Array(time_data, &new_time);
-		print_time_data(time_data);
+	uint8_t result = DateTime_ReadDS3231(&new_time);
+	if (result == OPERATION_DONE) {	
+		print_time(&new_time);
+	}
+	else if (result == OPERATION_TIMEOUT) {
+		// Bus was stuck and has been recovered, try again on the next poll
+		printf_P(PSTR("ERROR: Timed out reading time from DS3231\n"));
+		return;
 	}
 	else {
 		// Failed to read
-		printf("ERROR: Failed to read time from DS3231\n");
+		printf_P(PSTR("ERROR: Failed to read time from DS3231\n"));
 		return;
 	}
 	
-	if (DateTime_Equals(&clock->current_time, &new_time)) {
+	DateTime_Epoch now = DateTime_ToEpoch(&new_time);
+	if (now == clock->now) {
 		// time is the same, no further action is needed
 		return;
 	}
 	
-	// Update time and screen
-	clock->current_time = new_time;
-	time_display(clock);
+	// Update time, the screen is redrawn by AlarmClock_Render if it shows the time.
+	// The zone's rules are only evaluated when a DST transition has been passed.
+	clock->current_time = DateTime_FromEpoch(TimeZone_ToLocal(&clock->zone, now));
+	clock->now = now;
+	if (clock->menu.state == ALARM_CLOCK_MENU_DISPLAY_TIME) {
+		clock->redraw = 1;
+	}
 	
 	// Check alarm trigger
-	Alarm_CheckTrigger(&clock->alarm, &clock->current_time);
+	Alarm_CheckTrigger(&clock->alarm, clock->now);
+	update_backlight(clock);
 }
 
-uint8_t update_ds3231_time(AlarmClock *clock) {
-	uint8_t time_data[DATETIME_DS3231_DATA_LENGTH];
-	DateTime_ToDS3231Array(&clock->current_time, time_data);
-	if (ds3231_set(TIME, time_data) == OPERATION_DONE) {
-		return 1;
+// The DS3231 keeps UTC, which can change date when only the local time changes or the
+// other way around. All time registers are written in one burst, so a UTC midnight the
+// DS3231 passes after the last read cannot leave it with the old date or time.
+uint8_t set_local_time(AlarmClock *clock, const DateTime *local) {
+	DateTime_Epoch now = TimeZone_ToUTC(&clock->zone, DateTime_ToEpoch(local));
+	DateTime utc = DateTime_FromEpoch(now);
+	uint8_t result = DateTime_WriteDS3231(&utc);
+	if (result != OPERATION_DONE) {
+		printf_P(PSTR("Error: set_local_time failed!"));
+		return 0;
+	}
+	
+	clock->now = now;
+	clock->current_time = DateTime_FromEpoch(TimeZone_ToLocal(&clock->zone, now));
+	Alarm_Schedule(&clock->alarm, now, &clock->zone);
+	return 1;
+}
+
+// Set the backlight from the time of day and the alarm: dim at night, a ramp up to full
+// brightness that ends when the alarm rings, flashing while it rings.
+// Called every second, the backlight engine ignores requests for a fade already under way.
+void update_backlight(AlarmClock *clock) {
+	uint32_t now = DateTime_SecondOfDay(&clock->current_time);
+	uint32_t until_alarm = Alarm_SecondsUntil(&clock->alarm, clock->now);
+	
+	// An alarm that rang since the night started ends it, so the display stays bright once
+	// it has rung. A repeated local time on a DST change does not, as the alarm only rings once.
+	uint32_t since_night_start = (now + DATETIME_SECONDS_PER_DAY - NIGHT_START_HOUR * 3600UL) % DATETIME_SECONDS_PER_DAY;
+	uint8_t night = (now >= NIGHT_START_HOUR * 3600UL || now < NIGHT_END_HOUR * 3600UL)
+		&& clock->now - clock->alarm.rang_at > since_night_start;
+	
+	Backlight_Flash(clock->alarm.state == ALARM_BEEPING);
+	if (until_alarm <= WAKE_RAMP_MINUTES * 60UL) {
+		Backlight_FadeTo(BACKLIGHT_DAY_LEVEL, until_alarm * 1000);
+	}
+	else if (night) {
+		Backlight_FadeTo(BACKLIGHT_NIGHT_LEVEL, BACKLIGHT_DIM_FADE_MS);
 	}
 	else {
-		printf("Error: update_ds3231_time failed!");
-		return 0;
+		Backlight_FadeTo(BACKLIGHT_DAY_LEVEL, BACKLIGHT_DIM_FADE_MS);
 	}
 }
 
+// Debug output of the time read from the ds3231
+void print_time(const DateTime *time) {
+	printf_P(PSTR("%02u:%02u:%02u  %02u/%02u/20%02u UTC\n"), time->hour, time->minute, time->second, time->month, time->day, time->year);
+}
+
 uint8_t AlarmClock_InSettingsMenu(AlarmClock* clock) {
 	return (clock->menu.state != ALARM_CLOCK_MENU_DISPLAY_TIME);
 }
@@ -151,6 +232,40 @@ void AlarmClock_HandlePotInput(AlarmClock* clock, float pot_value) {
 	}
 }
 
+// The handlers above only set clock->redraw, the display of the current state is drawn here
+void AlarmClock_Render(AlarmClock* clock) {
+	if (!clock->redraw) {
+		return;
+	}
+	clock->redraw = 0;
+	
+	switch (clock->menu.state) {
+		case ALARM_CLOCK_MENU_DISPLAY_TIME:
+			time_display(clock);
+			break;
+		case ALARM_CLOCK_MENU_MAIN_SETTINGS:
+			main_settings_display();
+			break;
+		case ALARM_CLOCK_MENU_SET_TIME_DATE_SELECTION:
+			set_time_date_selection_display();
+			break;
+		case ALARM_CLOCK_MENU_SETTING_TIME:
+			setting_time_display(clock);
+			break;
+		case ALARM_CLOCK_MENU_SETTING_DATE:
+			setting_date_display(clock);
+			break;
+		case ALARM_CLOCK_MENU_SET_ALARM_SELECTION:
+			set_alarm_selection_display();
+			break;
+		case ALARM_CLOCK_MENU_SETTING_ALARM_TIME:
+			setting_alarm_display(clock);
+			break;
+		default:
+			break;
+	}
+}
+
 BuzzerState AlarmClock_GetBuzzerState(AlarmClock *clock) {
 	if (clock->alarm.state == ALARM_BEEPING) {
 		return ALARM_CLOCK_BUZZER_BEEPING;
@@ -158,7 +273,7 @@ BuzzerState AlarmClock_GetBuzzerState(AlarmClock *clock) {
 	return ALARM_CLOCK_BUZZER_SILENT;
 }
 
-void alarm_str(Alarm* alarm, char* buf, size_t len) {
+void alarm_str(Alarm* alarm, const TimeZone* zone, char* buf, size_t len) {
 	if (len < 17) 
 		// require 17 length (full line)
 		return;
@@ -166,24 +281,30 @@ void alarm_str(Alarm* alarm, char* buf, size_t len) {
 	switch (alarm->state) {
 				
 		case ALARM_DISABLED:
-			strcpy(buf, "No Alarm Set");
+			strcpy_P(buf, UI_NO_ALARM_SET);
 			break;
 				
 		case ALARM_OFF:
 		case ALARM_BEEPING:
-			strcpy(buf, "Alarm ");
-			DateTime_FormatTime(&alarm->time, &buf[6], len - 6, 1, 0);
+			DateTime_FormatTime(&alarm->time, Format_String_P(buf, UI_ALARM), len - 6, 1, 0);
 			break;
 				
-		case ALARM_SNOOZED:
-			strcpy(buf, "Snoozed ");
-			DateTime_FormatTime(&alarm->snoozed_till, &buf[8], len - 8, 1, 0);
+		case ALARM_SNOOZED: {
+			DateTime snoozed_till = DateTime_FromEpoch(TimeZone_ToLocalAt(zone, alarm->rings_at));
+			DateTime_FormatTime(&snoozed_till, Format_String_P(buf, UI_SNOOZED), len - 8, 1, 0);
 			break;
+		}
 	}
 }
 
 void time_display(AlarmClock *clock) {
 	if (clock->menu.state == ALARM_CLOCK_MENU_DISPLAY_TIME) {
+		LCD_cursor_off();
+		if (clock->display_mode == ALARM_CLOCK_DISPLAY_BIG_DIGITS && !clock->show_alarm_time) {
+			big_digits_time_display(clock);
+			return;
+		}
+		
 		char line1[17];
 		DateTime_FormatTime(&clock->current_time, line1, 17, 1, 1);
 		LCD_printline_centered(line1, 0);
@@ -191,33 +312,79 @@ void time_display(AlarmClock *clock) {
 		char line2[17];
 		
 		if (clock->show_alarm_time) {
-			alarm_str(&clock->alarm, line2, 17);
+			alarm_str(&clock->alarm, &clock->zone, line2, 17);
 		}
 		else if (!clock->current_time.dateValid) {
-			strcpy(line2, "No Date Set");
+			strcpy_P(line2, UI_NO_DATE_SET);
 		}
 		else {
-			const char* dow_str;
-			char date_string[9];
-			dow_str = DateTime_DayOfWeekToShortString(clock->current_time.dayOfWeek);
-			DateTime_FormatDate(&clock->current_time, date_string, 9);
-			sprintf(line2, "%s %s", dow_str, date_string);
+			// "DOW MM/DD/YY"
+			char* p = Format_String_P(line2, DateTime_DayOfWeekToShortString_P(clock->current_time.dayOfWeek));
+			*p++ = ' ';
+			DateTime_FormatDate(&clock->current_time, p, 9);
 		}
 		
 		LCD_printline_centered(line2, 1);
 	}
 }
 
+// Layout: hour tens and ones, colon, minute tens and ones (13 columns), a blank column,
+// then AM/PM over the seconds. Only the cells that change go to the LCD on each tick.
+void big_digits_time_display(AlarmClock *clock) {
+	DateTime_Hour12 h12 = DateTime_GetHour12(&clock->current_time);
+	uint8_t minute = clock->current_time.minute;
+	char side[4];
+	
+	BigDigits_Draw(h12.hour >= 10 ? h12.hour / 10 : BIG_DIGIT_BLANK, 0);
+	BigDigits_Draw(h12.hour % 10, 3);
+	BigDigits_DrawColon(6);
+	BigDigits_Draw(minute / 10, 7);
+	BigDigits_Draw(minute % 10, 10);
+	
+	side[0] = ' ';
+	*Format_String_P(&side[1], DateTime_AMPMToString_P(h12.ampm)) = '\0';
+	LCD_set_cursor(13, 0);
+	LCD_print(side);
+	*Format_TwoDigits(&side[1], clock->current_time.second) = '\0';
+	LCD_set_cursor(13, 1);
+	LCD_print(side);
+}
+
 void main_settings_display() {
-	LCD_printline("1: Set Time/Date", 0);
-	LCD_printline("2: Set Alarm", 1);
+	LCD_printline_P(UI_MENU_SET_TIME_DATE, 0);
+	LCD_printline_P(UI_MENU_SET_ALARM, 1);
 }
 
 void set_time_date_selection_display() {
-	LCD_printline("1: Set Time", 0);
-	LCD_printline("2: Set Date", 1);
+	LCD_cursor_off();
+	LCD_printline_P(UI_MENU_SET_TIME, 0);
+	LCD_printline_P(UI_MENU_SET_DATE, 1);
+}
+
+// Column of the character at `index` of a line printed with LCD_printline_centered
+uint8_t centered_column(const char* line, uint8_t index) {
+	size_t len = strlen(line);
+	return (len < LCD_COLUMNS ? (LCD_COLUMNS - len) / 2 : 0) + index;
+}
+
+// Column of the last digit of the hour, minute or second field of a time formatted
+// with DateTime_FormatTime (the hour has 1 or 2 digits). Returns 0 for other fields.
+uint8_t time_field_column(const char* time_str, TimeField field) {
+	uint8_t colon = strchr(time_str, ':') - time_str;
+	switch (field) {
+		case ALARM_CLOCK_TIME_FIELD_HOUR:
+			return centered_column(time_str, colon - 1);
+		case ALARM_CLOCK_TIME_FIELD_MINUTE:
+			return centered_column(time_str, colon + 2);
+		case ALARM_CLOCK_TIME_FIELD_SECOND:
+			return centered_column(time_str, colon + 5);
+		default:
+			return 0;
+	}
 }
 
+// The label stays on the second line while the fields are edited, the blinking cursor
+// marks the field. Only the value and the cursor position change on the LCD.
 void setting_time_display(AlarmClock *clock) {
 	char buf[17];
 	DateTime_FormatTime(&clock->menu.time_setting.time, buf, 16, 1, 1);
@@ -225,59 +392,63 @@ void setting_time_display(AlarmClock *clock) {
 	
 	switch (clock->menu.time_setting.field) {
 		case ALARM_CLOCK_TIME_FIELD_HOUR:
-			LCD_printline_centered("Set Hour", 1);
-			break;
 		case ALARM_CLOCK_TIME_FIELD_MINUTE:
-			LCD_printline_centered("Set Minute", 1);
-			break;
 		case ALARM_CLOCK_TIME_FIELD_SECOND:
-			LCD_printline_centered("Set Second", 1);
-			break;		
+			LCD_printline_centered_P(UI_LABEL_SET_TIME, 1);
+			LCD_cursor(time_field_column(buf, clock->menu.time_setting.field), 0);
+			break;
 		case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-			LCD_printline_centered("Confirm Time", 1);
+			LCD_cursor_off();
+			LCD_printline_centered_P(UI_LABEL_CONFIRM_TIME, 1);
 			break;
 		
 		default:
-			LCD_printline_centered("Error. Restart Device.", 1);
+			LCD_cursor_off();
+			LCD_printline_marquee_P(UI_ERROR_RESTART, 1);
 			break;
 	}
 }
 
 void setting_date_display(AlarmClock *clock) {
 	char buf[17];
-	const char* dow_str;
-	char date_string[9];
-	dow_str = DateTime_DayOfWeekToShortString(clock->menu.time_setting.time.dayOfWeek);
-	DateTime_FormatDate(&clock->menu.time_setting.time, date_string, 9);
-	sprintf(buf, "%s %s", dow_str, date_string);
+	// The day of week follows the date as it is edited
+	const char* dow_str = DateTime_DayOfWeekToShortString_P(DateTime_ComputeDayOfWeek(&clock->menu.time_setting.time));
+	char* p = Format_String_P(buf, dow_str);
+	*p++ = ' ';
+	DateTime_FormatDate(&clock->menu.time_setting.time, p, 9);
 	LCD_printline_centered(buf, 1);
 	
+	// Last character of each field in "DOW MM/DD/YY"
+	uint8_t dow_end = strlen_P(dow_str);
 	switch (clock->menu.time_setting.field) {
-		case ALARM_CLOCK_TIME_FIELD_DAY_OF_WEEK:
-			LCD_printline_centered("Set Day of Week", 0);
-			break;
 		case ALARM_CLOCK_TIME_FIELD_MONTH:
-			LCD_printline_centered("Set Month", 0);
+			LCD_printline_centered_P(UI_LABEL_SET_DATE, 0);
+			LCD_cursor(centered_column(buf, dow_end + 2), 1);
 			break;
 		case ALARM_CLOCK_TIME_FIELD_DAY:
-			LCD_printline_centered("Set Day", 0);
+			LCD_printline_centered_P(UI_LABEL_SET_DATE, 0);
+			LCD_cursor(centered_column(buf, dow_end + 5), 1);
 			break;
 		case ALARM_CLOCK_TIME_FIELD_YEAR:
-			LCD_printline_centered("Set Year", 0);
+			LCD_printline_centered_P(UI_LABEL_SET_DATE, 0);
+			LCD_cursor(centered_column(buf, dow_end + 8), 1);
 			break;
 		case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-			LCD_printline_centered("Confirm Date", 0);
+			LCD_cursor_off();
+			LCD_printline_centered_P(UI_LABEL_CONFIRM_DATE, 0);
 			break;	
 		
 		default:
-			LCD_printline_centered("Error. Restart Device.", 0);
+			LCD_cursor_off();
+			LCD_printline_marquee_P(UI_ERROR_RESTART, 0);
 			break;
 	}
 }
 
 void set_alarm_selection_display() {
-	LCD_printline("1: Set Alarm", 0);
-	LCD_printline("2: Clear Alarm", 1);
+	LCD_cursor_off();
+	LCD_printline_P(UI_MENU_ALARM_SET, 0);
+	LCD_printline_P(UI_MENU_ALARM_CLEAR, 1);
 }
 
 void setting_alarm_display(AlarmClock *clock) {
@@ -287,19 +458,18 @@ void setting_alarm_display(AlarmClock *clock) {
 	
 	switch (clock->menu.time_setting.field) {
 		case ALARM_CLOCK_TIME_FIELD_HOUR:
-			LCD_printline_centered("Alarm Set Hour", 1);
-			break;
 		case ALARM_CLOCK_TIME_FIELD_MINUTE:
-			LCD_printline_centered("Alarm Set Minute", 1);
-			break;
 		case ALARM_CLOCK_TIME_FIELD_SECOND:
-			LCD_printline_centered("Alarm Set Second", 1);
+			LCD_printline_centered_P(UI_LABEL_SET_ALARM, 1);
+			LCD_cursor(time_field_column(buf, clock->menu.time_setting.field), 0);
 			break;
 		case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-			LCD_printline_centered("Confirm Alarm", 1);
+			LCD_cursor_off();
+			LCD_printline_centered_P(UI_LABEL_CONFIRM_ALARM, 1);
 			break;		
 		default:
-			LCD_printline_centered("Error. Restart Device.", 1);
+			LCD_cursor_off();
+			LCD_printline_marquee_P(UI_ERROR_RESTART, 1);
 			break;
 	}	
 }
@@ -307,45 +477,52 @@ void setting_alarm_display(AlarmClock *clock) {
 void handle_button_input_time_display_state(AlarmClock *clock, ButtonState btn1, ButtonState btn2, ButtonState btn3) {
 	if (btn1.transition == BUTTON_JUST_PUSHED && clock->alarm.state != ALARM_BEEPING) {
 		clock->menu.state = ALARM_CLOCK_MENU_MAIN_SETTINGS;
-		main_settings_display();
+		clock->redraw = 1;
 	}
 	
 	if (btn2.push_state == BUTTON_PUSHED && clock->alarm.state != ALARM_BEEPING) {
 		if (!clock->show_alarm_time) {
 			clock->show_alarm_time = 1;
-			time_display(clock);
+			clock->redraw = 1;
 		}
 	}
 	else {
 		if (clock->show_alarm_time) {
 			clock->show_alarm_time = 0;
-			time_display(clock);
+			clock->redraw = 1;
 		}
 	}
 	
 	if (btn2.transition == BUTTON_JUST_PUSHED && clock->alarm.state == ALARM_BEEPING) {
-		Alarm_Off(&clock->alarm);
-		time_display(clock);
+		Alarm_Off(&clock->alarm, clock->now, &clock->zone);
+		update_backlight(clock);
+		clock->redraw = 1;
 	}
 	
 	if (btn3.transition == BUTTON_JUST_PUSHED && clock->alarm.state == ALARM_BEEPING) {
-		Alarm_Snooze(&clock->alarm, &clock->current_time);
-		time_display(clock);
-	}	
+		Alarm_Snooze(&clock->alarm, clock->now);
+		update_backlight(clock);
+		clock->redraw = 1;
+	}
+	else if (btn3.transition == BUTTON_JUST_PUSHED) {
+		// Switch between the text and big digit clock faces
+		clock->display_mode = (clock->display_mode == ALARM_CLOCK_DISPLAY_TEXT) ? ALARM_CLOCK_DISPLAY_BIG_DIGITS : ALARM_CLOCK_DISPLAY_TEXT;
+		clock->redraw = 1;
+	}
 }
 
 void handle_button_input_main_settings_state(AlarmClock *clock, ButtonState btn1, ButtonState btn2, ButtonState btn3) {
 	if (btn1.transition == BUTTON_JUST_PUSHED) {
 		clock->menu.state = ALARM_CLOCK_MENU_SET_TIME_DATE_SELECTION;
-		set_time_date_selection_display();
+		clock->redraw = 1;
 	}
 	if (btn2.transition == BUTTON_JUST_PUSHED) {
 		clock->menu.state = ALARM_CLOCK_MENU_SET_ALARM_SELECTION;
-		set_alarm_selection_display();
+		clock->redraw = 1;
 	}
 	if (btn3.transition == BUTTON_JUST_PUSHED) {
 		clock->menu.state = ALARM_CLOCK_MENU_DISPLAY_TIME;
-		time_display(clock);
+		clock->redraw = 1;
 	}	
 }
 
@@ -354,17 +531,17 @@ void handle_button_input_time_date_selection_state(AlarmClock *clock, ButtonStat
 		clock->menu.state = ALARM_CLOCK_MENU_SETTING_TIME;
 		clock->menu.time_setting.time = clock->current_time;
 		clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_HOUR;
-		setting_time_display(clock);
+		clock->redraw = 1;
 	}
 	if (btn2.transition == BUTTON_JUST_PUSHED) {
 		clock->menu.state = ALARM_CLOCK_MENU_SETTING_DATE;
 		clock->menu.time_setting.time = clock->current_time;
-		clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_DAY_OF_WEEK;
-		setting_date_display(clock);
+		clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_MONTH;
+		clock->redraw = 1;
 	}
 	if (btn3.transition == BUTTON_JUST_PUSHED) {
 		clock->menu.state = ALARM_CLOCK_MENU_MAIN_SETTINGS;
-		main_settings_display();
+		clock->redraw = 1;
 	}	
 }
 
@@ -374,23 +551,28 @@ void handle_button_input_setting_time_state(AlarmClock *clock, ButtonState btn1,
 			case ALARM_CLOCK_TIME_FIELD_HOUR:
 			case ALARM_CLOCK_TIME_FIELD_MINUTE:
 				clock->menu.time_setting.field = clock->menu.time_setting.field + 1;
-				setting_time_display(clock);
+				clock->redraw = 1;
 				break;
 				
 			case ALARM_CLOCK_TIME_FIELD_SECOND:
 				clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_CONFIRM;
-				setting_time_display(clock);
+				clock->redraw = 1;
 				break;
 							
-			case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-				clock->current_time = clock->menu.time_setting.time;
-				update_ds3231_time(clock);
+			case ALARM_CLOCK_TIME_FIELD_CONFIRM: {
+				// The date is kept
+				DateTime local = clock->current_time;
+				local.hour = clock->menu.time_setting.time.hour;
+				local.minute = clock->menu.time_setting.time.minute;
+				local.second = clock->menu.time_setting.time.second;
+				set_local_time(clock, &local);
 				clock->menu.state = ALARM_CLOCK_MENU_DISPLAY_TIME;
-				time_display(clock);
+				clock->redraw = 1;
 				break;
+			}
 	
 			default:
-				printf("ERROR! Invalid time field state reached\n");
+				printf_P(PSTR("ERROR! Invalid time field state reached\n"));
 				break;
 		}
 	}
@@ -399,22 +581,22 @@ void handle_button_input_setting_time_state(AlarmClock *clock, ButtonState btn1,
 			
 			case ALARM_CLOCK_TIME_FIELD_HOUR:
 				clock->menu.state = ALARM_CLOCK_MENU_SET_TIME_DATE_SELECTION;
-				set_time_date_selection_display();
+				clock->redraw = 1;
 				break;
 			
 			case ALARM_CLOCK_TIME_FIELD_MINUTE:
 			case ALARM_CLOCK_TIME_FIELD_SECOND:
 				clock->menu.time_setting.field = clock->menu.time_setting.field - 1;
-				setting_time_display(clock);
+				clock->redraw = 1;
 				break;
 					
 			case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-				clock->menu.state = ALARM_CLOCK_TIME_FIELD_SECOND;
-				setting_time_display(clock);
+				clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_SECOND;
+				clock->redraw = 1;
 				break;
 							
 			default:
-				printf("ERROR! Invalid time field state reached\n");
+				printf_P(PSTR("ERROR! Invalid time field state reached\n"));
 				break;
 		}
 	}
@@ -423,16 +605,13 @@ void handle_button_input_setting_time_state(AlarmClock *clock, ButtonState btn1,
 void handle_pot_input_setting_time_state(AlarmClock *clock, float pot_value) {
 	switch (clock->menu.time_setting.field) {
 		case ALARM_CLOCK_TIME_FIELD_HOUR:
-			clock->menu.time_setting.time.hour = MIN((uint8_t) ScaleFloat(pot_value, 0, 1, 0, 24), 23);
-			setting_time_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.hour, MIN((uint8_t) ScaleFloat(pot_value, 0, 1, 0, 24), 23));
 			break;
 		case ALARM_CLOCK_TIME_FIELD_MINUTE:
-			clock->menu.time_setting.time.minute = MIN((uint8_t) ScaleFloat(pot_value, 0, 1, 0, 60), 59);
-			setting_time_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.minute, MIN((uint8_t) ScaleFloat(pot_value, 0, 1, 0, 60), 59));
 			break;
 		case ALARM_CLOCK_TIME_FIELD_SECOND:
-			clock->menu.time_setting.time.second = MIN((uint8_t) ScaleFloat(pot_value, 0, 1, 0, 60), 59);
-			setting_time_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.second, MIN((uint8_t) ScaleFloat(pot_value, 0, 1, 0, 60), 59));
 			break;
 		default:
 			break;
@@ -442,52 +621,56 @@ void handle_pot_input_setting_time_state(AlarmClock *clock, float pot_value) {
 void handle_button_input_setting_date_state(AlarmClock *clock, ButtonState btn1, ButtonState btn2, ButtonState btn3) {
 	if (btn2.transition == BUTTON_JUST_PUSHED) {
 		switch (clock->menu.time_setting.field) {
-			case ALARM_CLOCK_TIME_FIELD_DAY_OF_WEEK:
 			case ALARM_CLOCK_TIME_FIELD_MONTH:
 			case ALARM_CLOCK_TIME_FIELD_DAY:
 				clock->menu.time_setting.field = clock->menu.time_setting.field + 1;
-				setting_date_display(clock);
+				clock->redraw = 1;
 				break;
 
 			case ALARM_CLOCK_TIME_FIELD_YEAR:
 				clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_CONFIRM;
-				setting_date_display(clock);
+				clock->redraw = 1;
 				break;
 
-			case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-				clock->current_time = clock->menu.time_setting.time;
-				update_ds3231_time(clock);
+			case ALARM_CLOCK_TIME_FIELD_CONFIRM: {
+				// The time keeps running
+				DateTime local = clock->current_time;
+				local.day = clock->menu.time_setting.time.day;
+				local.month = clock->menu.time_setting.time.month;
+				local.year = clock->menu.time_setting.time.year;
+				local.dateValid = 1;
+				set_local_time(clock, &local);
 				clock->menu.state = ALARM_CLOCK_MENU_DISPLAY_TIME;
-				time_display(clock);
+				clock->redraw = 1;
 				break;
+			}
 
 			default:
-				printf("ERROR! Invalid date field state reached\n");
+				printf_P(PSTR("ERROR! Invalid date field state reached\n"));
 				break;
 		}
 	}
 
 	if (btn3.transition == BUTTON_JUST_PUSHED) {
 		switch (clock->menu.time_setting.field) {
-			case ALARM_CLOCK_TIME_FIELD_DAY_OF_WEEK:
+			case ALARM_CLOCK_TIME_FIELD_MONTH:
 				clock->menu.state = ALARM_CLOCK_MENU_SET_TIME_DATE_SELECTION;
-				set_time_date_selection_display();
+				clock->redraw = 1;
 				break;
 
-			case ALARM_CLOCK_TIME_FIELD_MONTH:
 			case ALARM_CLOCK_TIME_FIELD_DAY:
 			case ALARM_CLOCK_TIME_FIELD_YEAR:
 				clock->menu.time_setting.field = clock->menu.time_setting.field - 1;
-				setting_date_display(clock);
+				clock->redraw = 1;
 				break;
 
 			case ALARM_CLOCK_TIME_FIELD_CONFIRM:
 				clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_YEAR;
-				setting_date_display(clock);
+				clock->redraw = 1;
 				break;
 
 			default:
-				printf("ERROR! Invalid date field state reached\n");
+				printf_P(PSTR("ERROR! Invalid date field state reached\n"));
 				break;
 		}
 	}
@@ -495,24 +678,17 @@ void handle_button_input_setting_date_state(AlarmClock *clock, ButtonState btn1,
 
 void handle_pot_input_setting_date_state(AlarmClock *clock, float pot_value) {
 	switch (clock->menu.time_setting.field) {
-		case ALARM_CLOCK_TIME_FIELD_DAY_OF_WEEK:
-			clock->menu.time_setting.time.dayOfWeek = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 1, 8), 7);
-			setting_date_display(clock);
-			break;
 		case ALARM_CLOCK_TIME_FIELD_MONTH:
-			clock->menu.time_setting.time.month = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 1, 13), 12);
-			setting_date_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.month, MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 1, 13), 12));
 			break;
 		case ALARM_CLOCK_TIME_FIELD_DAY: {
 			uint8_t max_day = DateTime_DaysInMonth(clock->menu.time_setting.time.month, DateTime_IsLeapYear(clock->menu.time_setting.time.year + ASSUMED_YEAR_OFFSET));
-			clock->menu.time_setting.time.day = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 1, max_day+1), max_day);
-			setting_date_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.day, MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 1, max_day+1), max_day));
 			break;
 		}
 		case ALARM_CLOCK_TIME_FIELD_YEAR:
 			// Stored as two-digit year (0099)
-			clock->menu.time_setting.time.year = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 100), 99);
-			setting_date_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.year, MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 100), 99));
 			break;
 		default:
 			break;
@@ -525,18 +701,19 @@ void handle_button_input_set_alarm_selection_state(AlarmClock *clock, ButtonStat
 		clock->menu.state = ALARM_CLOCK_MENU_SETTING_ALARM_TIME;
 		clock->menu.time_setting.time = clock->alarm.time;
 		clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_HOUR;
-		setting_alarm_display(clock);
+		clock->redraw = 1;
 	}
 	if (btn2.transition == BUTTON_JUST_PUSHED) {
 		// alarm cleared
 		clock->menu.state = ALARM_CLOCK_MENU_DISPLAY_TIME;
 		clock->alarm.state = ALARM_DISABLED;
-		time_display(clock);
+		update_backlight(clock);
+		clock->redraw = 1;
 	}
 	if (btn3.transition == BUTTON_JUST_PUSHED) {
 		// back to main settings page
 		clock->menu.state = ALARM_CLOCK_MENU_MAIN_SETTINGS;
-		main_settings_display();
+		clock->redraw = 1;
 	}	
 }
 
@@ -547,26 +724,30 @@ void handle_button_input_setting_alarm_state(AlarmClock *clock, ButtonState btn1
 			case ALARM_CLOCK_TIME_FIELD_MINUTE:
 				// advance to next field
 				clock->menu.time_setting.field = clock->menu.time_setting.field + 1;
-				setting_alarm_display(clock);
+				clock->redraw = 1;
 				break;
 
 			case ALARM_CLOCK_TIME_FIELD_SECOND:
 				// move to confirmation
 				clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_CONFIRM;
-				setting_alarm_display(clock);
+				clock->redraw = 1;
 				break;
 
 			case ALARM_CLOCK_TIME_FIELD_CONFIRM:
-				// apply the new alarm time and enable it
-				clock->alarm.time  = clock->menu.time_setting.time;
-				clock->alarm.state = ALARM_OFF;
+				// apply the new alarm time and enable it, keeping when the old one last rang
+				{
+					DateTime_Epoch rang_at = clock->alarm.rang_at;
+					clock->alarm = Alarm_New(clock->menu.time_setting.time, 1, clock->now, &clock->zone);
+					clock->alarm.rang_at = rang_at;
+				}
+				update_backlight(clock);
 				// return to normal display
 				clock->menu.state = ALARM_CLOCK_MENU_DISPLAY_TIME;
-				time_display(clock);
+				clock->redraw = 1;
 				break;
 
 			default:
-				printf("ERROR! Invalid alarm field state reached\n");
+				printf_P(PSTR("ERROR! Invalid alarm field state reached\n"));
 				break;
 		}
 	}
@@ -576,24 +757,24 @@ void handle_button_input_setting_alarm_state(AlarmClock *clock, ButtonState btn1
 			case ALARM_CLOCK_TIME_FIELD_HOUR:
 				// back to alarm menu
 				clock->menu.state = ALARM_CLOCK_MENU_SET_ALARM_SELECTION;
-				set_alarm_selection_display();
+				clock->redraw = 1;
 				break;
 
 			case ALARM_CLOCK_TIME_FIELD_MINUTE:
 			case ALARM_CLOCK_TIME_FIELD_SECOND:
 				// move back one field
 				clock->menu.time_setting.field = clock->menu.time_setting.field - 1;
-				setting_alarm_display(clock);
+				clock->redraw = 1;
 				break;
 
 			case ALARM_CLOCK_TIME_FIELD_CONFIRM:
 				// undo confirm, go back to seconds
 				clock->menu.time_setting.field = ALARM_CLOCK_TIME_FIELD_SECOND;
-				setting_alarm_display(clock);
+				clock->redraw = 1;
 				break;
 
 			default:
-				printf("ERROR! Invalid alarm field state reached\n");
+				printf_P(PSTR("ERROR! Invalid alarm field state reached\n"));
 				break;
 		}
 	}
@@ -602,18 +783,15 @@ void handle_button_input_setting_alarm_state(AlarmClock *clock, ButtonState btn1
 void handle_pot_input_setting_alarm_state(AlarmClock *clock, float pot_value) {
 	switch (clock->menu.time_setting.field) {
 		case ALARM_CLOCK_TIME_FIELD_HOUR:
-			clock->menu.time_setting.time.hour   = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 24), 23);
-			setting_alarm_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.hour, MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 24), 23));
 			break;
 
 		case ALARM_CLOCK_TIME_FIELD_MINUTE:
-			clock->menu.time_setting.time.minute = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 60), 59);
-			setting_alarm_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.minute, MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 60), 59));
 			break;
 
 		case ALARM_CLOCK_TIME_FIELD_SECOND:
-			clock->menu.time_setting.time.second = MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 60), 59);
-			setting_alarm_display(clock);
+			SET_FIELD(clock, clock->menu.time_setting.time.second, MIN((uint8_t)ScaleFloat(pot_value, 0, 1, 0, 60), 59));
 			break;
 
 		default:
@@ -10,11 +10,16 @@
 
 #include "datetime.h"
 #include "alarm.h"
+#include "timezone.h"
 #include "button.h"
 #include "potentiometer.h"
+#include "backlight.h"
+
+// Backlight levels of the day and of the night (see update_backlight in alarmclock.c)
+#define BACKLIGHT_DAY_LEVEL         BACKLIGHT_LEVEL_MAX
+#define BACKLIGHT_NIGHT_LEVEL       24
 
 typedef enum {
-	ALARM_CLOCK_TIME_FIELD_DAY_OF_WEEK,
 	ALARM_CLOCK_TIME_FIELD_MONTH,
 	ALARM_CLOCK_TIME_FIELD_DAY,
 	ALARM_CLOCK_TIME_FIELD_YEAR,
@@ -45,17 +50,26 @@ typedef struct {
 	AlarmClockTimeSettingMenu time_setting;
 } AlarmClockMenu;
 
+typedef enum {
+	ALARM_CLOCK_DISPLAY_TEXT,		// time on the first line, date on the second
+	ALARM_CLOCK_DISPLAY_BIG_DIGITS,		// hours and minutes two lines tall, seconds and AM/PM on the side
+} AlarmClockDisplayMode;
+
 typedef struct {
-	DateTime current_time;
+	DateTime current_time; // local time, as shown
+	DateTime_Epoch now; // the DS3231 time, UTC seconds since 2000, for comparisons and the alarm
+	TimeZone zone; // local time from `now`
 	Alarm alarm;
 	AlarmClockMenu menu;
 	uint8_t show_alarm_time; // if 1, show the alarm time instead of the weekday month/day/year, controlled by a button
+	AlarmClockDisplayMode display_mode; // how the time is shown, switched with a button
+	uint8_t redraw; // 1 if the handlers changed something on the display since the last render
 } AlarmClock;
 
 // Initializes and returns the AlarmClock in the initial state.
 AlarmClock AlarmClock_Init();
 
-// Initializes and returns the AlarmClock in the initial state and time
+// Initializes and returns the AlarmClock in the initial state and time (UTC)
 AlarmClock AlarmClock_InitWithTime(DateTime time);
 
 // The clock reads the updated time from the DS3231
@@ -75,6 +89,10 @@ void AlarmClock_HandleButtonInput(AlarmClock* clock, ButtonState btn1, ButtonSta
  */
 void AlarmClock_HandlePotInput(AlarmClock* clock, float pot_value);
 
+// Draw the display into the LCD framebuffer if the handlers changed it, at most once per call.
+// Call once per main loop iteration, after the handlers and before LCD_flush.
+void AlarmClock_Render(AlarmClock* clock);
+
 typedef enum {
 	ALARM_CLOCK_BUZZER_BEEPING,
 	ALARM_CLOCK_BUZZER_SILENT,
@@ -0,0 +1,141 @@
+/*
+ * backlight.c
+ *
+ * Created: 10/17/2026 8:10:44 PM
+ *  Author: agpri
+ */
+
+#include "backlight.h"
+#include "i2c_lib_S25.h"
+#include <util/atomic.h>
+
+// Registers, the register pointer auto-increments after each byte
+#define BACKLIGHT_REGISTER_MODE    0x00
+#define BACKLIGHT_REGISTER_PWM     0x04	// blue, then 0x05 and 0x06 for the other channels
+#define BACKLIGHT_REGISTER_UPDATE  0x07	// writing it latches the PWM registers
+#define BACKLIGHT_REGISTER_RESET   0x2F
+
+// Bus budget in bytes per second. A level write is 6 bytes, one per step is 300 bytes per second
+#define BACKLIGHT_BUS_BUDGET 512
+
+// PWM registers 0x04 to 0x06 and the update register 0x07, written in one transaction.
+// Sent in place, only the blue channel is used.
+static uint8_t pwm_registers[4];
+static volatile TWI_Status write_status = TWI_STATUS_DONE;
+static uint8_t sent_level;
+
+// Fade from start_level to target_level, fade_elapsed_ms of fade_duration_ms in
+static uint8_t start_level;
+static uint8_t target_level;
+static uint32_t fade_duration_ms;
+static uint32_t fade_elapsed_ms;
+
+static uint8_t flashing;
+static uint8_t flash_on;
+static uint16_t flash_ms;
+static uint8_t step_ms;
+
+static uint8_t fade_level();
+static void write_register(uint8_t reg, uint8_t value);
+
+void Backlight_Init() {
+	// Level changes can wait behind the LCD and the RTC
+	TWI_AddDevice(LCD_TWI_BUS, BACKLIGHT_ADDRESS, TWI_SPEED_STANDARD, TWI_PRIORITY_LOW, BACKLIGHT_BUS_BUDGET);
+	
+	//Reset Register for Backlight
+	write_register(BACKLIGHT_REGISTER_RESET, 0x00);
+	//Shutdown Register Write
+	write_register(BACKLIGHT_REGISTER_MODE, 0b00100000);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		start_level = BACKLIGHT_LEVEL_MAX;
+		target_level = BACKLIGHT_LEVEL_MAX;
+		fade_duration_ms = 0;
+		fade_elapsed_ms = 0;
+		flashing = 0;
+		// Sent on the first step
+		sent_level = 0;
+	}
+}
+
+void Backlight_FadeTo(uint8_t level, uint32_t duration_ms) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (level != target_level) {
+			start_level = fade_level();
+			target_level = level;
+			fade_duration_ms = duration_ms;
+			fade_elapsed_ms = 0;
+		}
+	}
+}
+
+void Backlight_Flash(uint8_t enabled) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (enabled && !flashing) {
+			flash_on = 1;
+			flash_ms = 0;
+		}
+		flashing = enabled;
+	}
+}
+
+uint8_t Backlight_GetLevel() {
+	uint8_t level;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		level = flashing ? (flash_on ? BACKLIGHT_LEVEL_MAX : 0) : fade_level();
+	}
+	return level;
+}
+
+void Backlight_Tick() {
+	if (fade_elapsed_ms < fade_duration_ms) {
+		fade_elapsed_ms++;
+	}
+	if (flashing && ++flash_ms >= BACKLIGHT_FLASH_PERIOD_MS) {
+		flash_ms = 0;
+		flash_on = !flash_on;
+	}
+	if (++step_ms < BACKLIGHT_STEP_MS) {
+		return;
+	}
+	step_ms = 0;
+	
+	// Whatever the level ended up as during the step is all that is sent.
+	// If the last write is still waiting for the bus, the new level goes on a later step.
+	uint8_t level = Backlight_GetLevel();
+	if (level == sent_level || write_status == TWI_STATUS_QUEUED || write_status == TWI_STATUS_BUSY) {
+		return;
+	}
+	pwm_registers[0] = level;
+	TWI_Transaction t = {
+		.address = BACKLIGHT_ADDRESS,
+		.header = {BACKLIGHT_REGISTER_PWM},
+		.header_length = 1,
+		.write_data = pwm_registers,
+		.write_length = sizeof(pwm_registers),
+		.status = &write_status,
+	};
+	if (TWI_TrySubmit(LCD_TWI_BUS, &t)) {
+		sent_level = level;
+	}
+}
+
+// Level of the fade at this point, called with interrupts off
+static uint8_t fade_level() {
+	if (fade_elapsed_ms >= fade_duration_ms) {
+		return target_level;
+	}
+	// In 16 ms units, so a fade of up to a day keeps the product within 32 bits
+	int32_t elapsed = fade_elapsed_ms >> 4;
+	int32_t duration = (fade_duration_ms >> 4) + 1;
+	return start_level + ((int32_t)target_level - start_level) * elapsed / duration;
+}
+
+static void write_register(uint8_t reg, uint8_t value) {
+	TWI_Transaction t = {
+		.address = BACKLIGHT_ADDRESS,
+		.header = {reg, value},
+		.header_length = 2,
+	};
+	TWI_Submit(LCD_TWI_BUS, &t);
+}
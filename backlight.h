@@ -0,0 +1,45 @@
+/*
+ * backlight.h
+ *
+ * Created: 10/17/2026 8:02:17 PM
+ *  Author: agpri
+ *
+ * LCD backlight brightness engine. Fades and flashing are advanced by the
+ * 1 ms timer. Every BACKLIGHT_STEP_MS the level they add up to is sent
+ * to the backlight driver as one write, and only if it changed. The
+ * functions below only change the schedule and never wait for the bus.
+ */
+
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <stdint.h>
+
+// I2C address of the backlight PWM driver, on the LCD's bus
+#define BACKLIGHT_ADDRESS 0x6B
+
+#define BACKLIGHT_LEVEL_MAX 255
+
+// Time between brightness writes, at most one small write per step goes on the bus
+#define BACKLIGHT_STEP_MS 20
+
+// Time the backlight spends on and off while flashing
+#define BACKLIGHT_FLASH_PERIOD_MS 250
+
+// Reset the backlight driver and turn it on at full brightness. Called by LCD_init.
+void Backlight_Init();
+
+// Fade linearly from the current level to `level` over `duration_ms` (0 to change at once).
+// Does nothing if a fade to the same level is already under way, so it can be called on every clock tick.
+void Backlight_FadeTo(uint8_t level, uint32_t duration_ms);
+
+// Flash between full brightness and off while `enabled`, then continue with the fade level
+void Backlight_Flash(uint8_t enabled);
+
+// Level the backlight is at, or heading to within a step
+uint8_t Backlight_GetLevel();
+
+// Advance fades and flashing and send the new level. Call from the 1 ms timer interrupt.
+void Backlight_Tick();
+
+#endif // BACKLIGHT_H
@@ -0,0 +1,134 @@
+/*
+ * bcd.c
+ *
+ * Created: 10/17/2026 5:55:02 PM
+ *  Author: agpri
+ */
+
+#include "bcd.h"
+#include <avr/pgmspace.h>
+
+// Tens in the high nibble, ones in the low nibble
+#define BCD_TABLE_ROW(tens) \
+	(tens) << 4 | 0, (tens) << 4 | 1, (tens) << 4 | 2, (tens) << 4 | 3, (tens) << 4 | 4, \
+	(tens) << 4 | 5, (tens) << 4 | 6, (tens) << 4 | 7, (tens) << 4 | 8, (tens) << 4 | 9
+
+static const uint8_t encode_table[BCD_TABLE_SIZE] PROGMEM = {
+	BCD_TABLE_ROW(0), BCD_TABLE_ROW(1), BCD_TABLE_ROW(2), BCD_TABLE_ROW(3), BCD_TABLE_ROW(4),
+	BCD_TABLE_ROW(5), BCD_TABLE_ROW(6), BCD_TABLE_ROW(7), BCD_TABLE_ROW(8), BCD_TABLE_ROW(9),
+};
+
+uint8_t BCD_Encode(uint8_t value) {
+#if BCD_KERNEL == BCD_KERNEL_SUBTRACT
+	return BCD_Encode_Subtract(value);
+#elif BCD_KERNEL == BCD_KERNEL_TABLE
+	return BCD_Encode_Table(value);
+#else
+	return BCD_Encode_MulShift(value);
+#endif
+}
+
+uint8_t BCD_Decode(uint8_t bcd) {
+#if BCD_KERNEL == BCD_KERNEL_SUBTRACT
+	return BCD_Decode_ShiftAdd(bcd);
+#else
+	return BCD_Decode_MulShift(bcd);
+#endif
+}
+
+uint8_t BCD_Encode_Subtract(uint8_t value) {
+	uint8_t bcd = 0;
+	while (value >= 10) {
+		bcd += 0x10;
+		value -= 10;
+	}
+	return bcd + value;
+}
+
+uint8_t BCD_Encode_Table(uint8_t value) {
+	// No range check, so every value takes the same cycles: value must be 0-99 (see bcd.h)
+	return pgm_read_byte(&encode_table[value]);
+}
+
+uint8_t BCD_Encode_MulShift(uint8_t value) {
+	// value / 10 == (value * 205) >> 11 for 0 to 1028, one 8x8 hardware multiply.
+	// 16 * tens + ones == value + 6 * tens
+	uint8_t tens = ((uint16_t)value * 205) >> 11;
+	return value + 6 * tens;
+}
+
+uint8_t BCD_Decode_ShiftAdd(uint8_t bcd) {
+	uint8_t tens = bcd >> 4;
+	return (tens << 3) + (tens << 1) + (bcd & 0x0F);
+}
+
+uint8_t BCD_Decode_MulShift(uint8_t bcd) {
+	// 10 * tens + ones == bcd - 6 * tens
+	return bcd - 6 * (bcd >> 4);
+}
+
+#ifdef BCD_BENCHMARK
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <stdio.h>
+
+typedef uint8_t (*BCD_Kernel)(uint8_t);
+
+static volatile uint8_t sink;
+
+static uint8_t empty_kernel(uint8_t value) {
+	return value;
+}
+
+// TCB1 ticks (CPU cycles) to run `kernel` over the 100 inputs, including the indirect call
+static uint16_t time_kernel(BCD_Kernel kernel, const uint8_t* inputs) {
+	uint16_t start, elapsed;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		start = TCB1.CNT;
+		for (uint8_t i = 0; i < 100; i++) {
+			sink = kernel(inputs[i]);
+		}
+		elapsed = TCB1.CNT - start;
+	}
+	return elapsed;
+}
+
+void BCD_Benchmark() {
+	static const struct {
+		const char* name;
+		BCD_Kernel kernel;
+		uint8_t bcd_input;
+	} kernels[] = {
+		{"encode subtract", BCD_Encode_Subtract, 0},
+		{"encode table", BCD_Encode_Table, 0},
+		{"encode mulshift", BCD_Encode_MulShift, 0},
+		{"decode shiftadd", BCD_Decode_ShiftAdd, 1},
+		{"decode mulshift", BCD_Decode_MulShift, 1},
+	};
+	uint8_t binary[100];
+	uint8_t bcd[100];
+	for (uint8_t value = 0; value < 100; value++) {
+		binary[value] = value;
+		bcd[value] = (value / 10) << 4 | (value % 10);
+	}
+
+	// Free running 16-bit counter at F_CPU
+	TCB1.CCMP = 0xFFFF;
+	TCB1.CTRLB = TCB_CNTMODE_INT_gc;
+	TCB1.CTRLA = TCB_CLKSEL_DIV1_gc | TCB_ENABLE_bm;
+
+	// Loop, indirect call and store, subtracted from every kernel
+	uint16_t overhead = time_kernel(empty_kernel, binary);
+
+	printf("BCD kernel       cycles per 100 bytes\n");
+	for (uint8_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+		uint16_t cycles = time_kernel(kernels[i].kernel, kernels[i].bcd_input ? bcd : binary);
+		printf("%-16s %u\n", kernels[i].name, cycles - overhead);
+	}
+	printf("encode table: %u bytes of flash\n", BCD_TABLE_SIZE);
+
+	TCB1.CTRLA = 0;
+}
+
+#endif // BCD_BENCHMARK
@@ -0,0 +1,47 @@
+/*
+ * bcd.h
+ *
+ * Created: 10/17/2026 5:48:31 PM
+ *  Author: agpri
+ *
+ * Binary <-> packed BCD conversion for values 0-99, as used by the DS3231
+ * time and alarm registers. Every variant is available for benchmarking
+ * (make -C sim bench on the host, BCD_Benchmark() on the target);
+ * BCD_KERNEL picks the one BCD_Encode and BCD_Decode use.
+ */
+
+#ifndef BCD_H
+#define BCD_H
+
+#include <stdint.h>
+
+#define BCD_KERNEL_SUBTRACT   0	// subtract 10 until below 10: 6 to 60+ cycles depending on the value
+#define BCD_KERNEL_TABLE      1	// 100 byte lookup table in flash, constant time
+#define BCD_KERNEL_MULSHIFT   2	// tens = (value * 205) >> 11 with the hardware multiplier, constant time
+
+#ifndef BCD_KERNEL
+#define BCD_KERNEL BCD_KERNEL_MULSHIFT
+#endif
+
+// Size of the BCD_KERNEL_TABLE lookup table, in bytes of flash
+#define BCD_TABLE_SIZE 100
+
+// Binary 0-99 to packed BCD, with the kernel chosen by BCD_KERNEL
+uint8_t BCD_Encode(uint8_t value);
+
+// Packed BCD 0x00-0x99 to binary, constant time for every kernel
+uint8_t BCD_Decode(uint8_t bcd);
+
+// The individual kernels
+uint8_t BCD_Encode_Subtract(uint8_t value);
+uint8_t BCD_Encode_Table(uint8_t value);	// value 0-99 only, there is no range check
+uint8_t BCD_Encode_MulShift(uint8_t value);	// value + 6 * tens
+uint8_t BCD_Decode_ShiftAdd(uint8_t bcd);	// tens * 8 + tens * 2 + ones
+uint8_t BCD_Decode_MulShift(uint8_t bcd);	// bcd - 6 * tens
+
+#ifdef BCD_BENCHMARK
+// Print the cycles each kernel takes for 100 bytes to stdout (the UART), timed with TCB1
+void BCD_Benchmark();
+#endif
+
+#endif // BCD_H
@@ -0,0 +1,85 @@
+/*
+ * bigdigits.c
+ *
+ * Created: 10/17/2026 7:20:05 PM
+ *  Author: agpri
+ */
+
+#include "bigdigits.h"
+#include "lcd_dfr0555.h"
+
+// Character ROM codes used next to the glyphs
+#define FULL_BLOCK  0xFF
+#define MIDDLE_DOT  0xA5
+
+// Parts a digit is drawn from: 7 glyphs (8 rows of 5 dots each) and two ROM characters
+enum {
+	LEFT_TOP,	// rounded top left corner
+	UPPER_BAR,
+	RIGHT_TOP,	// rounded top right corner
+	LEFT_BOTTOM,	// rounded bottom left corner
+	LOWER_BAR,
+	RIGHT_BOTTOM,	// rounded bottom right corner
+	UPPER_MIDDLE,	// upper bar and the top of a middle bar
+	BLANK,		// not a glyph: a space
+	BLOCK,		// not a glyph: the full block from the character ROM
+};
+
+static const uint8_t glyph_bitmaps[BLANK][8] = {
+	[LEFT_TOP]     = {0x07, 0x0F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+	[UPPER_BAR]    = {0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00},
+	[RIGHT_TOP]    = {0x1C, 0x1E, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+	[LEFT_BOTTOM]  = {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x0F, 0x07},
+	[LOWER_BAR]    = {0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F},
+	[RIGHT_BOTTOM] = {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1E, 0x1C},
+	[UPPER_MIDDLE] = {0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x1F, 0x1F},
+};
+
+// Top and bottom line of each digit, then the blank digit
+static const uint8_t digit_parts[BIG_DIGIT_BLANK + 1][2][BIG_DIGIT_WIDTH] = {
+	{{LEFT_TOP, UPPER_BAR, RIGHT_TOP}, {LEFT_BOTTOM, LOWER_BAR, RIGHT_BOTTOM}},
+	{{UPPER_BAR, RIGHT_TOP, BLANK}, {LOWER_BAR, BLOCK, LOWER_BAR}},
+	{{UPPER_MIDDLE, UPPER_MIDDLE, RIGHT_TOP}, {LEFT_BOTTOM, LOWER_BAR, LOWER_BAR}},
+	{{UPPER_MIDDLE, UPPER_MIDDLE, RIGHT_TOP}, {LOWER_BAR, LOWER_BAR, RIGHT_BOTTOM}},
+	{{LEFT_BOTTOM, LOWER_BAR, BLOCK}, {BLANK, BLANK, BLOCK}},
+	{{LEFT_BOTTOM, UPPER_MIDDLE, UPPER_MIDDLE}, {LOWER_BAR, LOWER_BAR, RIGHT_BOTTOM}},
+	{{LEFT_TOP, UPPER_MIDDLE, UPPER_MIDDLE}, {LEFT_BOTTOM, LOWER_BAR, RIGHT_BOTTOM}},
+	{{UPPER_BAR, UPPER_BAR, RIGHT_TOP}, {BLANK, BLANK, BLOCK}},
+	{{LEFT_TOP, UPPER_MIDDLE, RIGHT_TOP}, {LEFT_BOTTOM, LOWER_BAR, RIGHT_BOTTOM}},
+	{{LEFT_TOP, UPPER_MIDDLE, RIGHT_TOP}, {LOWER_BAR, LOWER_BAR, RIGHT_BOTTOM}},
+	{{BLANK, BLANK, BLANK}, {BLANK, BLANK, BLANK}},
+};
+
+static char part_code(uint8_t part) {
+	switch (part) {
+		case BLANK:
+			return ' ';
+		case BLOCK:
+			return (char)FULL_BLOCK;
+		default:
+			return LCD_glyph(glyph_bitmaps[part]);
+	}
+}
+
+void BigDigits_Draw(uint8_t digit, uint8_t column) {
+	if (digit > BIG_DIGIT_BLANK) {
+		digit = BIG_DIGIT_BLANK;
+	}
+	for (uint8_t line = 0; line < 2; line++) {
+		char cells[BIG_DIGIT_WIDTH + 1];
+		for (uint8_t i = 0; i < BIG_DIGIT_WIDTH; i++) {
+			cells[i] = part_code(digit_parts[digit][line][i]);
+		}
+		cells[BIG_DIGIT_WIDTH] = '\0';
+		LCD_set_cursor(column, line);
+		LCD_print(cells);
+	}
+}
+
+void BigDigits_DrawColon(uint8_t column) {
+	const char colon[] = {(char)MIDDLE_DOT, '\0'};
+	LCD_set_cursor(column, 0);
+	LCD_print(colon);
+	LCD_set_cursor(column, 1);
+	LCD_print(colon);
+}
@@ -0,0 +1,28 @@
+/*
+ * bigdigits.h
+ *
+ * Created: 10/17/2026 7:12:40 PM
+ *  Author: agpri
+ *
+ * Digits two lines tall and three columns wide, drawn into the LCD framebuffer
+ * from 8 custom glyphs (the LCD's glyph cache uploads them on first use).
+ */
+
+#ifndef BIGDIGITS_H
+#define BIGDIGITS_H
+
+#include <stdint.h>
+
+// Columns a big digit takes
+#define BIG_DIGIT_WIDTH 3
+
+// Pass as the digit to blank the digit's cells
+#define BIG_DIGIT_BLANK 10
+
+// Draw a digit (0-9 or BIG_DIGIT_BLANK) over both lines, starting at `column`
+void BigDigits_Draw(uint8_t digit, uint8_t column);
+
+// Draw a colon over both lines, one column wide
+void BigDigits_DrawColon(uint8_t column);
+
+#endif // BIGDIGITS_H
@@ -6,46 +6,34 @@
  */ 
 
 #include "datetime.h"
-#include <stdio.h>
+#include "format.h"
 #include <string.h>
+#include <avr/pgmspace.h>
 
-// Static mapping for full day-of-week names (index 0 is invalid)
-static const char * const DOW_NAMES[] = {
-	"", "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
-};
-
-// Static mapping for short day-of-week names
-static const char * const DOW_SHORT_NAMES[] = {
+// Short day-of-week names in flash (index 0 is invalid), fixed width rows so there is no pointer table
+static const char DOW_SHORT_NAMES[8][4] PROGMEM = {
 	"", "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
 };
 
-// Map AM/PM to string
-static const char * const AMPM_STRINGS[] = { "AM", "PM" };
+// Map AM/PM to string, in flash
+static const char AMPM_STRINGS[2][3] PROGMEM = { "AM", "PM" };
 
-void DateTime_FromDS3231Array(const uint8_t data[DATETIME_DS3231_DATA_LENGTH],
-DateTime *dt) {
-	// DS3231 BCD decode is handled elsewhere; copy raw values
-	dt->second    = data[DATETIME_DS3231_REG_SECOND];
-	dt->minute    = data[DATETIME_DS3231_REG_MINUTE];
-	dt->hour      = data[DATETIME_DS3231_REG_HOUR];
-	dt->dayOfWeek = (DateTime_DayOfWeek)data[DATETIME_DS3231_REG_DAY_OF_WEEK];
-	dt->day       = data[DATETIME_DS3231_REG_DAY];
-	dt->month     = data[DATETIME_DS3231_REG_MONTH];
-	dt->year      = data[DATETIME_DS3231_REG_YEAR]; // assume offset
+// Bit n is set if month n has 31 days; the others have 30, except February
+#define MONTHS_WITH_31_DAYS 0x15AA
 
-	dt->dateValid = 1;
-}
+// Days in a 400 year Gregorian cycle, and from 0000-03-01 to 2000-01-01 in the proleptic calendar
+#define DAYS_PER_ERA 146097UL
+#define DAYS_TO_2000 730425UL
 
-void DateTime_ToDS3231Array(const DateTime *dt,
-uint8_t data[DATETIME_DS3231_DATA_LENGTH]) {
-	data[DATETIME_DS3231_REG_SECOND]      = dt->second;
-	data[DATETIME_DS3231_REG_MINUTE]      = dt->minute;
-	data[DATETIME_DS3231_REG_HOUR]        = dt->hour;
-	data[DATETIME_DS3231_REG_DAY_OF_WEEK] = (uint8_t)dt->dayOfWeek;
-	data[DATETIME_DS3231_REG_DAY]         = dt->day;
-	data[DATETIME_DS3231_REG_MONTH]       = dt->month;
-	data[DATETIME_DS3231_REG_YEAR]        = dt->year;
-}
+// 2000-01-01 was a Saturday
+#define DAY_0_DAY_OF_WEEK DateTime_Saturday
+
+// Sakamoto's month offsets: the day of week of the 0th of each month, relative to the
+// year's, in a year counted from March
+static const uint8_t DOW_MONTH_OFFSETS[12] PROGMEM = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+static uint32_t days_from_civil(uint16_t year, uint8_t month, uint8_t day);
+static void civil_from_days(uint32_t days, uint16_t *year, uint8_t *month, uint8_t *day);
 
 uint8_t DateTime_Equals(const DateTime *a, const DateTime *b) {
 	return (a->second    == b->second  &&
@@ -65,6 +53,89 @@ uint8_t DateTime_TimeEquals(const DateTime *a, const DateTime *b) {
 	a->second == b->second);
 }
 
+DateTime_Epoch DateTime_ToEpoch(const DateTime *dt) {
+	DateTime_Epoch t = DateTime_SecondOfDay(dt);
+	if (dt->dateValid) {
+		t += days_from_civil(2000 + dt->year % 100, dt->month, dt->day) * DATETIME_SECONDS_PER_DAY;
+	}
+	return t;
+}
+
+DateTime DateTime_FromEpoch(DateTime_Epoch t) {
+	DateTime dt;
+	uint32_t days = t / DATETIME_SECONDS_PER_DAY;
+	uint32_t second_of_day = t % DATETIME_SECONDS_PER_DAY;
+	uint16_t minute_of_day = second_of_day / 60;
+	dt.second = second_of_day % 60;
+	dt.minute = minute_of_day % 60;
+	dt.hour = minute_of_day / 60;
+	
+	uint16_t year;
+	civil_from_days(days, &year, &dt.month, &dt.day);
+	dt.year = year % 100;
+	dt.dateValid = 1;
+	dt.dayOfWeek = (DateTime_DayOfWeek)((days + DAY_0_DAY_OF_WEEK - DateTime_Sunday) % 7 + DateTime_Sunday);
+	return dt;
+}
+
+// Sakamoto's method: whole years shift the day of week by one, leap years by two
+DateTime_DayOfWeek DateTime_ComputeDayOfWeek(const DateTime *dt) {
+	uint16_t year = 2000 + dt->year % 100 - (dt->month < 3);
+	uint16_t dow = year + year / 4 - year / 100 + year / 400 + pgm_read_byte(&DOW_MONTH_OFFSETS[dt->month - 1]) + dt->day;
+	return (DateTime_DayOfWeek)(dow % 7 + DateTime_Sunday);
+}
+
+DateTime DateTime_AddDuration(const DateTime *dt, int16_t days, int16_t hours, int16_t minutes, int32_t seconds) {
+	int32_t delta = seconds + minutes * 60L + hours * 3600L + days * (int32_t)DATETIME_SECONDS_PER_DAY;
+	if (dt->dateValid) {
+		return DateTime_FromEpoch(DateTime_ToEpoch(dt) + delta);
+	}
+	
+	// Without a date the time wraps around midnight
+	int32_t second_of_day = ((int32_t)DateTime_SecondOfDay(dt) + delta) % (int32_t)DATETIME_SECONDS_PER_DAY;
+	if (second_of_day < 0) {
+		second_of_day += DATETIME_SECONDS_PER_DAY;
+	}
+	DateTime res = *dt;
+	res.hour = second_of_day / 3600;
+	res.minute = (second_of_day / 60) % 60;
+	res.second = second_of_day % 60;
+	res.dayOfWeek = DateTime_Invalid_Day;
+	return res;
+}
+
+int32_t DateTime_Difference(const DateTime *a, const DateTime *b) {
+	return (int32_t)(DateTime_ToEpoch(a) - DateTime_ToEpoch(b));
+}
+
+// Days from 2000-01-01 to a date, without loops (H. Hinnant's days_from_civil).
+// The year is counted from March, so the leap day is the last day of the year before.
+uint32_t days_from_civil(uint16_t year, uint8_t month, uint8_t day) {
+	year -= month <= 2;
+	uint16_t era = year / 400;
+	uint16_t year_of_era = year - era * 400;										// 0-399
+	uint16_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;	// 0-365
+	uint32_t day_of_era = year_of_era * 365UL + year_of_era / 4 - year_of_era / 100 + day_of_year;
+	return era * DAYS_PER_ERA + day_of_era - DAYS_TO_2000;
+}
+
+// Date of a day counted from 2000-01-01, the inverse of days_from_civil
+void civil_from_days(uint32_t days, uint16_t *year, uint8_t *month, uint8_t *day) {
+	days += DAYS_TO_2000;
+	uint16_t era = days / DAYS_PER_ERA;
+	uint32_t day_of_era = days - era * DAYS_PER_ERA;											// 0-146096
+	uint16_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;	// 0-399
+	uint16_t day_of_year = day_of_era - (year_of_era * 365UL + year_of_era / 4 - year_of_era / 100);	// 0-365
+	uint8_t month_from_march = (5 * day_of_year + 2) / 153;										// 0-11
+	*day = day_of_year - (153 * month_from_march + 2) / 5 + 1;
+	*month = month_from_march < 10 ? month_from_march + 3 : month_from_march - 9;
+	*year = year_of_era + era * 400 + (*month <= 2);
+}
+
+uint32_t DateTime_SecondOfDay(const DateTime *dt) {
+	return dt->hour * 3600UL + dt->minute * 60 + dt->second;
+}
+
 DateTime_Hour12 DateTime_GetHour12(const DateTime *dt) {
 	DateTime_Hour12 h12;
 	uint8_t h = dt->hour;
@@ -84,8 +155,8 @@ DateTime_Hour12 DateTime_GetHour12(const DateTime *dt) {
 	return h12;
 }
 
-const char *DateTime_AMPMToString(DateTime_AMPM ampm) {
-	if (ampm > DateTime_PM) return "";
+const char *DateTime_AMPMToString_P(DateTime_AMPM ampm) {
+	if (ampm > DateTime_PM) return DOW_SHORT_NAMES[0];
 	return AMPM_STRINGS[ampm];
 }
 
@@ -114,22 +185,19 @@ char* DateTime_FormatTime(const DateTime *dt, char *buffer, size_t len, uint8_t
 		return NULL;
 	}
 
+	// "H:MM:SS AM" / "HH:MM:SS", without the seconds if not included
+	char *p = Format_Hour(buffer, dt->hour, twelveHourFmt);
+	*p++ = ':';
+	p = Format_TwoDigits(p, dt->minute);
+	if (includeSeconds) {
+		*p++ = ':';
+		p = Format_TwoDigits(p, dt->second);
+	}
 	if (twelveHourFmt) {
-		DateTime_Hour12 h12 = DateTime_GetHour12(dt);
-		if (includeSeconds) {
-			sprintf(buffer, "%u:%02u:%02u %s", h12.hour, dt->minute, dt->second, DateTime_AMPMToString(h12.ampm));
-		} else {
-			sprintf(buffer, "%u:%02u %s", h12.hour, dt->minute, DateTime_AMPMToString(h12.ampm));
-		}
-	} 
-	else 
-	{
-		if (includeSeconds) {
-			sprintf(buffer, "%02u:%02u:%02u", dt->hour, dt->minute, dt->second);
-		} else {
-			sprintf(buffer, "%02u:%02u", dt->hour, dt->minute);
-		}
+		*p++ = ' ';
+		p = Format_String_P(p, DateTime_AMPMToString_P(dt->hour < 12 ? DateTime_AM : DateTime_PM));
 	}
+	*p = '\0';
 	return buffer;
 }
 
@@ -139,52 +207,23 @@ char* DateTime_FormatDate(const DateTime *dt, char *buffer, size_t len) {
 	if (len < required) {
 		return NULL;
 	}
-	sprintf(buffer, "%02u/%02u/%02u", dt->month, dt->day, dt->year % 100);
+	char *p = Format_TwoDigits(buffer, dt->month);
+	*p++ = '/';
+	p = Format_TwoDigits(p, dt->day);
+	*p++ = '/';
+	p = Format_TwoDigits(p, dt->year % 100);
+	*p = '\0';
 	return buffer;
 }
 
-const char* DateTime_DayOfWeekToString(DateTime_DayOfWeek dow) {
-	if (dow < DateTime_Sunday || dow > DateTime_Saturday)
-	return "";
-	return DOW_NAMES[dow];
-}
-
-const char* DateTime_DayOfWeekToShortString(DateTime_DayOfWeek dow) {
+const char* DateTime_DayOfWeekToShortString_P(DateTime_DayOfWeek dow) {
 	if (dow < DateTime_Sunday || dow > DateTime_Saturday)
-	return "";
+	return DOW_SHORT_NAMES[0];
 	return DOW_SHORT_NAMES[dow];
 }
 
 DateTime DateTime_AddTimeDuration(const DateTime *dt, unsigned int hours, unsigned int minutes, unsigned int seconds) {
-	DateTime res = *dt;
-
-	// Local accumulators
-	unsigned int hour   = dt->hour;
-	unsigned int minute = dt->minute;
-	unsigned int second = dt->second;
-
-	// Add seconds, minutes, hours
-	second += seconds;
-	minute += second / 60;
-	second %= 60;
-
-	minute += minutes;
-	hour   += minute / 60;
-	minute %= 60;
-
-	hour += hours;
-	hour %= 24;
-
-	// Update result time fields
-	res.hour   = (uint8_t)hour;
-	res.minute = (uint8_t)minute;
-	res.second = (uint8_t)second;
-
-	// Invalidate date 
-	res.dateValid = 0;
-	res.dayOfWeek = DateTime_Invalid_Day;
-	
-	return res;
+	return DateTime_AddDuration(dt, 0, hours, minutes, seconds);
 }
 
 uint8_t DateTime_IsLeapYear(unsigned int year) {
@@ -195,29 +234,14 @@ uint8_t DateTime_IsLeapYear(unsigned int year) {
 }
 
 uint8_t DateTime_DaysInMonth(uint8_t month, uint8_t leap_year) {
-    switch (month) {
-        case 1:   // January
-        case 3:   // March
-        case 5:   // May
-        case 7:   // July
-        case 8:   // August
-        case 10:  // October
-        case 12:  // December
-            return 31;
-
-        case 4:   // April
-        case 6:   // June
-        case 9:   // September
-        case 11:  // November
-            return 30;
-
-        case 2:   // February
-            return leap_year ? 29 : 28;
-
-        default:
-            // Invalid month
-            return 0;
-    }
+	if (month < 1 || month > 12) {
+		// Invalid month
+		return 0;
+	}
+	if (month == 2) {
+		return leap_year ? 29 : 28;
+	}
+	return 30 + ((MONTHS_WITH_31_DAYS >> month) & 1);
 }
 
 
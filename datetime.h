@@ -48,29 +48,20 @@ typedef struct {
 	DateTime_DayOfWeek dayOfWeek; 
 } DateTime;
 
-// DS3231 register indices (BCD) for 7-byte array
-#define DATETIME_DS3231_REG_SECOND      0
-#define DATETIME_DS3231_REG_MINUTE      1
-#define DATETIME_DS3231_REG_HOUR        2
-#define DATETIME_DS3231_REG_DAY_OF_WEEK 3
-#define DATETIME_DS3231_REG_DAY         4
-#define DATETIME_DS3231_REG_MONTH       5
-#define DATETIME_DS3231_REG_YEAR        6
-#define DATETIME_DS3231_DATA_LENGTH     7
-
-// Translate a 7-byte DS3231 BCD array into a DateTime
-// Arguments:
-// - data: pointer to 7-byte input array (BCD)
-// - dt:   pointer to output DateTime (dateValid=1, dowValid=1)
-void DateTime_FromDS3231Array(const uint8_t data[DATETIME_DS3231_DATA_LENGTH],
-DateTime *dt);
+// Seconds since 2000-01-01 00:00:00. Compare and subtract these instead of the fields.
+// Dates are limited to the DS3231's 2000-2099.
+typedef uint32_t DateTime_Epoch;
 
-// Encode a DateTime into a 7-byte DS3231 BCD array
-// Arguments:
-// - dt:   pointer to DateTime to encode
-// - data: pointer to 7-byte output array (BCD)
-void DateTime_ToDS3231Array(const DateTime *dt,
-uint8_t data[DATETIME_DS3231_DATA_LENGTH]);
+#define DATETIME_SECONDS_PER_DAY 86400UL
+
+// Seconds since 2000 of a DateTime. Without a valid date, the seconds since midnight.
+DateTime_Epoch DateTime_ToEpoch(const DateTime *dt);
+
+// DateTime (with date and day of week) of seconds since 2000, without loops
+DateTime DateTime_FromEpoch(DateTime_Epoch t);
+
+// Day of week of the date of a DateTime (valid date required), in constant time
+DateTime_DayOfWeek DateTime_ComputeDayOfWeek(const DateTime *dt);
 
 // Compare two DateTime structs (date + time)
 // Returns 1 if exactly equal, 0 otherwise
@@ -80,6 +71,9 @@ uint8_t DateTime_Equals(const DateTime *a, const DateTime *b);
 // Returns 1 if hour, minute, second match, 0 otherwise
 uint8_t DateTime_TimeEquals(const DateTime *a, const DateTime *b);
 
+// Seconds since midnight of the time portion, 0 to 86399
+uint32_t DateTime_SecondOfDay(const DateTime *dt);
+
 // Convert 24h hour to 12-hour format
 // Arguments:
 // - dt: pointer to DateTime with hour in 023
@@ -89,8 +83,8 @@ DateTime_Hour12 DateTime_GetHour12(const DateTime *dt);
 // Convert AM/PM enum to "AM" or "PM"
 // Arguments:
 // - ampm: DateTime_AM or DateTime_PM
-// Returns pointer to static string "AM" or "PM"
-const char *DateTime_AMPMToString(DateTime_AMPM ampm);
+// Returns pointer to string "AM" or "PM" in flash
+const char *DateTime_AMPMToString_P(DateTime_AMPM ampm);
 
 // Format time portion of a DateTime into a string
 // Arguments:
@@ -110,26 +104,29 @@ char *DateTime_FormatTime(const DateTime *dt, char *buffer, size_t len, uint8_t
 // Returns pointer to buffer
 char *DateTime_FormatDate(const DateTime *dt, char *buffer, size_t len);
 
-// Full day-of-week name from enum
-// Arguments:
-// - dow: one of DateTime_DOW_* values
-// Returns pointer to static string or empty if invalid
-const char *DateTime_DayOfWeekToString(DateTime_DayOfWeek dow);
-
 // Three-letter day-of-week name from enum
 // Arguments:
 // - dow: one of DateTime_DOW_* values
-// Returns pointer to static 3-letter string or empty if invalid
-const char *DateTime_DayOfWeekToShortString(DateTime_DayOfWeek dow);
+// Returns pointer to 3-letter string in flash, empty if invalid
+const char *DateTime_DayOfWeekToShortString_P(DateTime_DayOfWeek dow);
 
 // Add a duration to the time of a DateTime, normalizing all time fields.
-// This function does not update the date. It invalidates the date and day of week.
+// The date rolls over with it if it is valid, see DateTime_AddDuration.
 // Arguments:
 // - dt: source DateTime
 // - hours, minutes, seconds: duration
 // Returns: new DateTime with adjustments
 DateTime DateTime_AddTimeDuration(const DateTime *dt, unsigned int hours, unsigned int minutes, unsigned int seconds);
 
+// Add a duration to a DateTime, any part of it negative to subtract. With a valid date,
+// the date, month and year roll over and the day of week is updated; the result must stay
+// within 2000-2099. Without a date, the time wraps around midnight.
+// Constant time whatever the duration (no loops over days or months).
+DateTime DateTime_AddDuration(const DateTime *dt, int16_t days, int16_t hours, int16_t minutes, int32_t seconds);
+
+// Seconds from b to a (a - b), negative if a is earlier
+int32_t DateTime_Difference(const DateTime *a, const DateTime *b);
+
 // Returns the days in a given month (1-12) and uses leap_year parameter for February
 uint8_t DateTime_DaysInMonth(uint8_t month, uint8_t leap_year);
 
@@ -0,0 +1,57 @@
+/*
+ * datetime_ds3231.c
+ *
+ * Created: 10/17/2026 5:10:19 PM
+ *  Author: agpri
+ */
+
+#include "datetime_ds3231.h"
+#include "ds3231.h"
+
+#define TIME_REGISTER_COUNT 7
+
+// Called from the TWI interrupt with each time register as it is sent
+static uint8_t encode_field(void *context, uint8_t register_address) {
+	const DateTime *dt = context;
+	uint8_t value;
+	switch (register_address) {
+		case DS3231_REGISTER_SECONDS:     value = dt->second; break;
+		case DS3231_REGISTER_MINUTES:     value = dt->minute; break;
+		case DS3231_REGISTER_HOURS:       value = dt->hour; break;
+		case DS3231_REGISTER_DAY_OF_WEEK: value = (uint8_t)DateTime_ComputeDayOfWeek(dt); break;
+		case DS3231_REGISTER_DATE:        value = dt->day; break;
+		case DS3231_REGISTER_MONTH:       value = dt->month; break;
+		default:                          value = dt->year % 100; break;
+	}
+	return ds3231_register_encode(register_address, value);
+}
+
+// Called from the TWI interrupt with each time register as it is received
+static void decode_field(void *context, uint8_t register_address, uint8_t value) {
+	DateTime *dt = context;
+	value = ds3231_register_decode(register_address, value);
+	switch (register_address) {
+		case DS3231_REGISTER_SECONDS:     dt->second = value; break;
+		case DS3231_REGISTER_MINUTES:     dt->minute = value; break;
+		case DS3231_REGISTER_HOURS:       dt->hour = value; break;
+		case DS3231_REGISTER_DAY_OF_WEEK: dt->dayOfWeek = (DateTime_DayOfWeek)value; break;
+		case DS3231_REGISTER_DATE:        dt->day = value; break;
+		case DS3231_REGISTER_MONTH:       dt->month = value; break;
+		default:                          dt->year = value; break;
+	}
+}
+
+uint8_t DateTime_ReadDS3231(DateTime *dt) {
+	dt->dateValid = 1;
+	uint8_t result = time_i2c_read_decoded(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, TIME_REGISTER_COUNT, decode_field, dt);
+	if (result == OPERATION_DONE) {
+		// The date decides the day of week, whatever the register holds
+		dt->dayOfWeek = DateTime_ComputeDayOfWeek(dt);
+	}
+	return result;
+}
+
+uint8_t DateTime_WriteDS3231(const DateTime *dt) {
+	// The encoder only reads the DateTime
+	return time_i2c_write_encoded(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, TIME_REGISTER_COUNT, encode_field, (void *)dt);
+}
@@ -0,0 +1,29 @@
+/*
+ * datetime_ds3231.h
+ *
+ * Created: 10/17/2026 5:02:44 PM
+ *  Author: agpri
+ *
+ * Reads and writes a DateTime straight from and to the DS3231 time registers.
+ * Each field is converted to or from BCD as its byte goes over the bus, so there
+ * is no register array in between and no shared state: the DateTime itself is
+ * the only buffer.
+ */
+
+#ifndef DATETIME_DS3231_H
+#define DATETIME_DS3231_H
+
+#include "datetime.h"
+
+// Read the time and date registers into a DateTime (dateValid = 1) in one burst.
+// The day of week is computed from the date, the register is not trusted.
+// Returns OPERATION_DONE, OPERATION_FAILED or OPERATION_TIMEOUT (see ds3231.h).
+// dt is only complete if OPERATION_DONE is returned.
+uint8_t DateTime_ReadDS3231(DateTime *dt);
+
+// Write a DateTime to the time and date registers in one burst, in 24-hour mode.
+// The day of week register gets the day of week of the date.
+// Returns OPERATION_DONE, OPERATION_FAILED or OPERATION_TIMEOUT (see ds3231.h).
+uint8_t DateTime_WriteDS3231(const DateTime *dt);
+
+#endif // DATETIME_DS3231_H
@@ -1,17 +1,20 @@
 /*DS3231 high level driver - Reza Ebrahimi v1.0*/
 /*This is MCU independent; there's no need to change the contents of this file. Use low level api to adapt the driver to your MCU of choice*/
 #include "ds3231.h"
+#include "bcd.h"
 #include <stdio.h>
 
-static void BCD_to_HEX(uint8_t *data_array, uint8_t array_length);        /*turns the bcd time values from ds3231 into hex*/
-static void HEX_to_BCD(uint8_t *data_array, uint8_t array_length);        /*turns the hex numbers into bcd, to be written back into ds3231*/
-static void ds3231_data_clone(uint8_t option, uint8_t *input_array);        /*clones an array into one of 3 ..._registers_clone[], based on chosen option*/
+typedef struct
+{
+  uint8_t *data_array;
+  uint8_t start_register;
+} register_array;        /*binary values of consecutive registers, encoded or decoded one byte at a time on the bus*/
+
+static uint8_t write_array(uint8_t start_register, uint8_t *data_array, uint8_t array_length);        /*writes binary values as bcd, without touching data_array*/
+static uint8_t read_array(uint8_t start_register, uint8_t *data_array, uint8_t array_length);        /*reads bcd registers into data_array as binary values*/
+static uint8_t encode_array(void *context, uint8_t register_address);
+static void decode_array(void *context, uint8_t register_address, uint8_t value);
 
-static uint8_t register_current_value;        /*used to read current values of ds3231 registers*/
-static uint8_t register_new_value;        /*used to write new values to ds3231 registers*/
-static uint8_t time_registers_clone[7];       /*used for the purpose of not curropting the time settings by reconverting an already converted HEX to BCD array*/
-static uint8_t alarm1_registers_clone[4];       /*used for the purpose of not curropting the time settings by reconverting an already converted HEX to BCD array*/
-static uint8_t alarm2_registers_clone[3];       /*used for the purpose of not curropting the time settings by reconverting an already converted HEX to BCD array*/
 static uint8_t register_default_value[] = {       /*used in reset function, contains default values*/
   DS3231_REGISTER_SECONDS_DEFAULT,
   DS3231_REGISTER_MINUTES_DEFAULT,
@@ -56,6 +59,8 @@ void ds3231_init(uint8_t *data_array, uint8_t run_command, uint8_t reset_state)
 /*function to command ds3231 to stop or start updating its time registers, WORKS ONLY WITH BATTERY BACKED DS3231*/
 uint8_t ds3231_run_command(uint8_t command)
 {
+  uint8_t register_current_value;
+  uint8_t register_new_value;
   switch (command)
   {
     case CLOCK_RUN:
@@ -76,6 +81,7 @@ uint8_t ds3231_run_command(uint8_t command)
 /*function to check the status of ds3231, whether its running or not. WORKS ONLY WITH BATTERY BACKED DS3231*/
 uint8_t ds3231_run_status()
 {
+  uint8_t register_current_value;
   time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, &register_current_value);
   if ((register_current_value && (1 << DS3231_BIT_EOSC)) == 0)
     return CLOCK_RUN;
@@ -86,6 +92,7 @@ uint8_t ds3231_run_status()
 /*function to read the oscillator flag OSF and to decide whether it has been reset beforehand or not*/
 uint8_t ds3231_init_status_report()
 {
+  uint8_t register_current_value;
   time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_current_value);
   if (register_current_value & (1 << DS3231_BIT_OSF))
     return DS3231_NOT_INITIALIZED;
@@ -96,6 +103,8 @@ uint8_t ds3231_init_status_report()
 /*function to reset the OSF bit (OSF = 0)*/
 void ds3231_init_status_update()
 {
+  uint8_t register_current_value;
+  uint8_t register_new_value;
   time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_current_value);
   register_new_value = register_current_value & (~(1 << DS3231_BIT_OSF));
   time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_new_value);
@@ -104,37 +113,20 @@ void ds3231_init_status_update()
 /*resets the desired register(s), without affecting run_state (RUN_STATE ONLY MAKES SENSE WITH BATTERY-BACKED DS3231*/
 void ds3231_reset(uint8_t option)
 {
-  /*data_clone function together with registers_clone static variables, prevent data curroption caused by reconvertig HEX to BCD*/
-  ds3231_data_clone(TIME, &register_default_value[0]);
-  ds3231_data_clone(ALARM1, &register_default_value[7]);
-  ds3231_data_clone(ALARM2, &register_default_value[0X0B]);
-  HEX_to_BCD(&time_registers_clone[0], 7);
-  HEX_to_BCD(&alarm1_registers_clone[0], 4);
-  HEX_to_BCD(&alarm2_registers_clone[0], 3);
+  /*the defaults are encoded to bcd as they are sent, register_default_value itself is never converted*/
+  uint8_t register_current_value;
+  uint8_t register_new_value;
   switch (option)
   {
     case SECOND:
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, &time_registers_clone[0]);
-      break;
     case MINUTE:
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_MINUTES, &time_registers_clone[1]);
-      break;
-    case HOUR:
-      time_registers_clone[2] &= (~(1 << DS3231_BIT_12_24));        /*to turn on 24 hours format by default*/
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_HOURS, &time_registers_clone[2]);
-      break;
+    case HOUR:        /*encoding clears the 12/24 bit, 24 hours format by default*/
     case DAY_OF_WEEK:
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_DAY_OF_WEEK, &time_registers_clone[3]);
-      break;
     case DATE:
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_DATE, &time_registers_clone[4]);
-      break;
-    case MONTH:
-      time_registers_clone[5] &= (~(1 << DS3231_BIT_CENTURY));
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_MONTH, &time_registers_clone[5]);
-      break;
+    case MONTH:        /*encoding clears the century bit*/
     case YEAR:
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_YEAR, &time_registers_clone[6]);
+      register_new_value = ds3231_register_encode(option, register_default_value[option]);
+      time_i2c_write_single(DS3231_I2C_ADDRESS, option, &register_new_value);
       break;
     case CONTROL:
       time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, &register_current_value);       /*in order to preserve running state (RUN or HALT)*/
@@ -147,28 +139,23 @@ void ds3231_reset(uint8_t option)
       time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_new_value);
       break;
     case ALARM1:
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_ALARM1_SECONDS, &alarm1_registers_clone[0], 4);
+      write_array(DS3231_REGISTER_ALARM1_SECONDS, &register_default_value[7], 4);
       break;
     case ALARM2:
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_ALARM2_MINUTES, &alarm2_registers_clone[0], 3);
+      write_array(DS3231_REGISTER_ALARM2_MINUTES, &register_default_value[0X0B], 3);
       break;
     case ALARMS:
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_ALARM1_SECONDS, &alarm1_registers_clone[0], 4);
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_ALARM2_MINUTES, &alarm2_registers_clone[0], 3);
+      write_array(DS3231_REGISTER_ALARM1_SECONDS, &register_default_value[7], 7);
       break;
     case AGING_OFFSET:
       register_new_value = DS3231_REGISTER_AGING_OFFSET_DEFAULT;
       time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_AGING_OFFSET, &register_new_value);
     case TIME:
-      time_registers_clone[2] &= (~(1 << DS3231_BIT_12_24));
-      time_registers_clone[5] &= (~(1 << DS3231_BIT_CENTURY));
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, &time_registers_clone[0], 7);
+      write_array(DS3231_REGISTER_SECONDS, &register_default_value[0], 7);
       break;
     case ALL:
-      /*TIME registers reset*/
-      time_registers_clone[2] &= (~(1 << DS3231_BIT_12_24));        /*to preserve 24 hours mode*/
-      time_registers_clone[5] &= (~(1 << DS3231_BIT_CENTURY));        /*resetting century bit*/
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, &time_registers_clone[0], 7);       /*to reset all the TIME registers*/
+      /*TIME registers reset, 24 hours mode and century bit cleared by the encoding*/
+      write_array(DS3231_REGISTER_SECONDS, &register_default_value[0], 7);       /*to reset all the TIME registers*/
       /*CONTROL and CONTROL_STATUS registers reset*/
       time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_current_value);       /*in order to preserve OSF flag*/
       register_new_value = (register_current_value & (1 << DS3231_BIT_OSF)) | (register_default_value[0X0F] & (~(1 << DS3231_BIT_EOSC)));
@@ -188,179 +175,153 @@ void ds3231_reset(uint8_t option)
 /*function to read internal registers of ds3231, one register at a time or an array of registers*/
 uint8_t ds3231_read(uint8_t option, uint8_t *data_array)
 {
+  uint8_t result = OPERATION_DONE;
+  uint8_t register_current_value;
   switch (option)
   {
-    case SECOND:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
-      break;
+    case SECOND:        /*option is the register address for SECOND to YEAR*/
     case MINUTE:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_MINUTES, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
-      break;
     case HOUR:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_HOURS, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
-      break;
     case DAY_OF_WEEK:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_DAY_OF_WEEK, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
-      break;
     case DATE:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_DATE, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
-      break;
     case MONTH:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_MONTH, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
-      break;
     case YEAR:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_YEAR, &register_current_value);
-      *data_array = register_current_value;
-      BCD_to_HEX(data_array, 1);
+      result = time_i2c_read_single(DS3231_I2C_ADDRESS, option, &register_current_value);
+      *data_array = ds3231_register_decode(option, register_current_value);
       break;
     case CONTROL:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, &register_current_value);
-      *data_array = register_current_value;
+      result = time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, data_array);
       break;
     case CONTROL_STATUS:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_current_value);
-      *data_array = register_current_value;
+      result = time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, data_array);
       break;
     case AGING_OFFSET:
-      time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_AGING_OFFSET, &register_current_value);
-      *data_array = register_current_value;
+      result = time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_AGING_OFFSET, data_array);
     case TIME:
-      time_i2c_read_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, data_array, 7);
-      BCD_to_HEX(data_array, 7);
+      result = read_array(DS3231_REGISTER_SECONDS, data_array, 7);
+      break;
+    case ALARM1:
+      result = read_array(DS3231_REGISTER_ALARM1_SECONDS, data_array, 4);
+      break;
+    case ALARM2:
+      result = read_array(DS3231_REGISTER_ALARM2_MINUTES, data_array, 3);
+      break;
+    case ALARMS:
+      result = read_array(DS3231_REGISTER_ALARM1_SECONDS, data_array, 7);
+      break;
+    case ALL:
+      /*raw register values, data_array must hold DS3231_REGISTER_COUNT bytes*/
+      result = time_i2c_read_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, data_array, DS3231_REGISTER_COUNT);
       break;
     default:
       return OPERATION_FAILED;
   }
-  return OPERATION_DONE;
+  return result;
 }
 
 /*function to set internal registers of ds3231, one register at a time or an array of registers*/
 uint8_t ds3231_set(uint8_t option, uint8_t *data_array)
 {
+  uint8_t result = OPERATION_DONE;
+  uint8_t register_current_value;
+  uint8_t register_new_value;
   switch (option)
   {
-    case SECOND:
-      time_registers_clone[0] = *data_array;
-      HEX_to_BCD(&time_registers_clone[0], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, &time_registers_clone[0]);
-      break;
+    case SECOND:        /*option is the register address for SECOND to YEAR*/
     case MINUTE:
-      time_registers_clone[1] = *data_array;
-      HEX_to_BCD(&time_registers_clone[1], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_MINUTES, &time_registers_clone[1]);
-      break;
     case HOUR:
-      time_registers_clone[2] = *data_array;
-      HEX_to_BCD(&time_registers_clone[2], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_HOURS, &time_registers_clone[2]);
-      break;
     case DAY_OF_WEEK:
-      time_registers_clone[3] = *data_array;
-      HEX_to_BCD(&time_registers_clone[3], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_DAY_OF_WEEK, &time_registers_clone[3]);
-      break;
     case DATE:
-      time_registers_clone[4] = *data_array;
-      HEX_to_BCD(&time_registers_clone[4], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_DATE, &time_registers_clone[4]);
-      break;
     case MONTH:
-      time_registers_clone[5] = *data_array;
-      HEX_to_BCD(&time_registers_clone[5], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_MONTH, &time_registers_clone[5]);
-      break;
     case YEAR:
-      time_registers_clone[6] = *data_array;
-      HEX_to_BCD(&time_registers_clone[6], 1);
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_YEAR, &time_registers_clone[6]);
+      register_new_value = ds3231_register_encode(option, *data_array);
+      result = time_i2c_write_single(DS3231_I2C_ADDRESS, option, &register_new_value);
       break;
     case CONTROL:
       time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, &register_current_value);
       register_new_value = (register_current_value & (1 << DS3231_BIT_EOSC)) | (*data_array & (~(1 << DS3231_BIT_EOSC)));
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, &register_new_value);
+      result = time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL, &register_new_value);
       break;
     case CONTROL_STATUS:
       time_i2c_read_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_current_value);
       register_new_value = (register_current_value & (1 << DS3231_BIT_OSF)) | (*data_array & (~(1 << DS3231_BIT_OSF)));
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_new_value);
+      result = time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_CONTROL_STATUS, &register_new_value);
       break;                                                                                         
     case TIME:
-      ds3231_data_clone(TIME, data_array);
-      HEX_to_BCD(&time_registers_clone[0], 7);
-      time_i2c_write_multi(DS3231_I2C_ADDRESS, DS3231_REGISTER_SECONDS, &time_registers_clone[0], 7);
+      /*data_array is encoded byte by byte as it is sent and is left as it was*/
+      result = write_array(DS3231_REGISTER_SECONDS, data_array, 7);
       break;
     case AGING_OFFSET:
-      register_new_value = *data_array;
-      time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_AGING_OFFSET, &register_new_value);
+      result = time_i2c_write_single(DS3231_I2C_ADDRESS, DS3231_REGISTER_AGING_OFFSET, data_array);
       break;
     default:
       return OPERATION_FAILED;
   }
-  return OPERATION_DONE;
+  return result;
 }
 
-/*to clone the desired data and prevent reconversion of BCD to HEX*/
-static void ds3231_data_clone(uint8_t option, uint8_t *input_array)
+/*binary time or alarm value to register value, other registers are written as they are*/
+uint8_t ds3231_register_encode(uint8_t register_address, uint8_t value)
 {
-  switch (option)
+  switch (register_address)
   {
-    case TIME:
-      for (uint8_t counter = 0; counter < 7; counter++)
-      {
-        time_registers_clone[counter] = input_array[counter];
-      }
-      break;
-    case ALARM1:
-      for (uint8_t counter = 0; counter < 4; counter++)
-      {
-        alarm1_registers_clone[counter] = input_array[counter];
-      }
-      break;
-    case ALARM2:
-      for (uint8_t counter = 0; counter < 3; counter++)
-      {
-        alarm2_registers_clone[counter] = input_array[counter];
-      }
-      break;
+    case DS3231_REGISTER_HOURS:
+      return BCD_Encode(value) & (~(1 << DS3231_BIT_12_24));        /*24 hours format*/
+    case DS3231_REGISTER_MONTH:
+      return BCD_Encode(value) & (~(1 << DS3231_BIT_CENTURY));
     default:
-      break;
+      if (register_address < DS3231_REGISTER_CONTROL)
+        return BCD_Encode(value);
+      return value;
   }
 }
 
-/*internal function related to this file and not accessible from outside*/
-static void BCD_to_HEX(uint8_t *data_array, uint8_t array_length)
+/*register value to binary time or alarm value, dropping the 12/24, century, AxMx mask and DY/DT bits*/
+uint8_t ds3231_register_decode(uint8_t register_address, uint8_t value)
 {
-  for (int8_t index = (array_length - 1); index >= 0; index--)
+  switch (register_address)
   {
-    data_array[index] = ((data_array[index] >> 4) << 1) + ((data_array[index] >> 4) << 3) + (data_array[index] & 0X0F);
+    case DS3231_REGISTER_SECONDS:
+    case DS3231_REGISTER_MINUTES:
+    case DS3231_REGISTER_ALARM1_SECONDS:
+    case DS3231_REGISTER_ALARM1_MINUTES:
+    case DS3231_REGISTER_ALARM2_MINUTES:
+      return BCD_Decode(value & 0X7F);
+    case DS3231_REGISTER_DAY_OF_WEEK:
+      return value & 0X07;
+    case DS3231_REGISTER_MONTH:
+      return BCD_Decode(value & 0X1F);
+    case DS3231_REGISTER_YEAR:
+      return BCD_Decode(value);
+    default:
+      if (register_address < DS3231_REGISTER_CONTROL)
+        return BCD_Decode(value & 0X3F);        /*hours, date and the alarm hours and day/date*/
+      return value;
   }
 }
 
-/*internal function related to this file and not accessible from outside*/
-static void HEX_to_BCD(uint8_t *data_array, uint8_t array_length)
+static uint8_t write_array(uint8_t start_register, uint8_t *data_array, uint8_t array_length)
 {
-  uint8_t temporary_value;
-  for (int8_t index = (array_length - 1); index >= 0; index--)
-  {
-    temporary_value = 0;
-    while (((int8_t)data_array[index] - 0X0A) >= 0)
-    {
-      temporary_value += 0X10;
-      data_array[index] -= 0X0A;
-    }
-    temporary_value += data_array[index];
-    data_array[index] = temporary_value;
-  }
+  register_array array = {data_array, start_register};
+  return time_i2c_write_encoded(DS3231_I2C_ADDRESS, start_register, array_length, encode_array, &array);
+}
+
+static uint8_t read_array(uint8_t start_register, uint8_t *data_array, uint8_t array_length)
+{
+  register_array array = {data_array, start_register};
+  return time_i2c_read_decoded(DS3231_I2C_ADDRESS, start_register, array_length, decode_array, &array);
+}
+
+/*called from the TWI interrupt for each register of write_array*/
+static uint8_t encode_array(void *context, uint8_t register_address)
+{
+  register_array *array = context;
+  return ds3231_register_encode(register_address, array->data_array[register_address - array->start_register]);
+}
+
+/*called from the TWI interrupt for each register of read_array*/
+static void decode_array(void *context, uint8_t register_address, uint8_t value)
+{
+  register_array *array = context;
+  array->data_array[register_address - array->start_register] = ds3231_register_decode(register_address, value);
 }
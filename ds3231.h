@@ -32,6 +32,7 @@ enum ds3231_registers {
   };
   
 #define DS3231_I2C_ADDRESS                    0X68
+#define DS3231_REGISTER_COUNT                 0X13
 
 #define FORCE_RESET                           0X00
 #define NO_FORCE_RESET                        0X01
@@ -40,6 +41,7 @@ enum ds3231_registers {
 #define DS3231_IS_STOPPED                     0X00
 #define OPERATION_DONE                        0X01
 #define OPERATION_FAILED                      0X00
+#define OPERATION_TIMEOUT                     0X02        /*the I2C transaction did not complete in time, the bus was recovered*/
 #define DS3231_NOT_INITIALIZED                0X01        /*bit OSF == 1 indicates that the oscillator was stopped*/
 #define DS3231_INITIALIZED                    0X00        /*bit OSF == 0 indicates that the oscillator was running before mcu was powered on*/
 
@@ -97,10 +99,19 @@ uint8_t ds3231_init_status_report();
 uint8_t ds3231_run_command(uint8_t command);
 uint8_t ds3231_run_status();
 
+/*register codecs: convert register values one byte at a time as they go over the bus, context is passed through*/
+typedef uint8_t (*ds3231_encoder)(void *context, uint8_t register_address);        /*returns the value to write to register_address*/
+typedef void (*ds3231_decoder)(void *context, uint8_t register_address, uint8_t value);        /*takes the value read from register_address*/
+
+uint8_t ds3231_register_encode(uint8_t register_address, uint8_t value);        /*binary time or alarm value to register value (BCD), other registers unchanged*/
+uint8_t ds3231_register_decode(uint8_t register_address, uint8_t value);        /*register value (BCD) to binary time or alarm value, dropping flag bits, other registers unchanged*/
+
 void ds3231_I2C_init();
-void time_i2c_write_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte);
-void time_i2c_write_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length);
-void time_i2c_read_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte);
-void time_i2c_read_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length);
+uint8_t time_i2c_write_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte);
+uint8_t time_i2c_write_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length);
+uint8_t time_i2c_read_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte);
+uint8_t time_i2c_read_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length);
+uint8_t time_i2c_write_encoded(uint8_t device_address, uint8_t start_register_address, uint8_t data_length, ds3231_encoder encoder, void *context);
+uint8_t time_i2c_read_decoded(uint8_t device_address, uint8_t start_register_address, uint8_t data_length, ds3231_decoder decoder, void *context);
 
 #endif
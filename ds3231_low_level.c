@@ -3,63 +3,143 @@
 
 #include "ds3231.h"
 #include "i2c_lib_S25.h"
-#include <util/delay.h>
+#include <stddef.h>
+
+/* state of an encoded or decoded transfer, lives on the caller's stack for the length of the transfer */
+typedef struct
+{
+	ds3231_encoder encoder;
+	ds3231_decoder decoder;
+	void *context;
+	uint8_t start_register_address;
+} register_stream;
+
+static uint8_t stream_write_byte(TWI_Transaction *t, uint8_t index);
+static void stream_read_byte(TWI_Transaction *t, uint8_t index, uint8_t data);
+
+static const TWI_Stream codec_stream = {stream_write_byte, stream_read_byte};
+
+/* translates the TWI transaction result into OPERATION_DONE, OPERATION_FAILED or OPERATION_TIMEOUT */
+static uint8_t operation_result(TWI_Status status)
+{
+	switch (status)
+	{
+		case TWI_STATUS_DONE:
+			return OPERATION_DONE;
+		case TWI_STATUS_TIMEOUT:
+			return OPERATION_TIMEOUT;
+		default:
+			return OPERATION_FAILED;
+	}
+}
 
 /* function to transmit one byte of data to register_address on ds3231 (device_address: 0x68) */
-void time_i2c_write_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte)
+uint8_t time_i2c_write_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte)
 {
-	/* Start write transaction */
-	TWI_Address(device_address, TW_WRITE);
-	/* Send register address */
-	TWI_Transmit_Data(register_address);
-	/* Send data byte */
-	TWI_Transmit_Data(*data_byte);
-	/* End transaction */
-	TWI_Stop();
+	/* Register address followed by the data byte, in one write transaction */
+	TWI_Transaction t = {
+		.address = device_address,
+		.header = {register_address, *data_byte},
+		.header_length = 2,
+	};
+	return operation_result(TWI_Transfer(DS3231_TWI_BUS, &t));
 }
 
 /* function to transmit an array of data to device_address, starting from start_register_address */
-void time_i2c_write_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length)
+uint8_t time_i2c_write_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length)
 {
-	// Start write transaction 
-	TWI_Address(device_address, TW_WRITE);
-	// Send start register address 
-	TWI_Transmit_Data(start_register_address);
-	// Send data bytes
-	for (uint8_t i = 0; i < data_length; i++) {
-		TWI_Transmit_Data(data_array[i]);
-	}
-	// End transaction 
-	TWI_Stop();
+	// Start register address, then the data bytes.
+	// data_array is sent in place, so wait for the transfer before returning
+	TWI_Transaction t = {
+		.address = device_address,
+		.header = {start_register_address},
+		.header_length = 1,
+		.write_data = data_array,
+		.write_length = data_length,
+	};
+	return operation_result(TWI_Transfer(DS3231_TWI_BUS, &t));
 }
 
 /* function to read one byte of data from register_address on ds3231 */
-void time_i2c_read_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte)
+uint8_t time_i2c_read_single(uint8_t device_address, uint8_t register_address, uint8_t *data_byte)
 {
-	// Set register pointer 
-	TWI_Address(device_address, TW_WRITE);
-	TWI_Transmit_Data(register_address);
-	// Repeated start for read 
-	TWI_Address(device_address, TW_READ);
-	// Read data byte 
-	*data_byte = TWI_Receive_Data();
-	// End transaction
-	TWI_Stop();
+	// Set register pointer, then repeated start to read the data byte
+	TWI_Transaction t = {
+		.address = device_address,
+		.header = {register_address},
+		.header_length = 1,
+		.read_data = data_byte,
+		.read_length = 1,
+	};
+	return operation_result(TWI_Transfer(DS3231_TWI_BUS, &t));
 }
 
-/* function to read an array of data from device_address */
-void time_i2c_read_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length)
+/* function to read an array of data from device_address, starting from start_register_address,
+   in one transaction so that the registers are read as one consistent snapshot */
+uint8_t time_i2c_read_multi(uint8_t device_address, uint8_t start_register_address, uint8_t *data_array, uint8_t data_length)
 {
-	for (uint8_t i = 0; i < data_length; i++) {
-		/* read one byte from register (start + i) */
-		time_i2c_read_single(device_address,
-		start_register_address + i,
-		&data_array[i]);
-	}
+	// Set register pointer, then repeated start and read data_length bytes.
+	// Every byte but the last is ACKed, the DS3231 auto-increments the register pointer
+	TWI_Transaction t = {
+		.address = device_address,
+		.header = {start_register_address},
+		.header_length = 1,
+		.read_data = data_array,
+		.read_length = data_length,
+	};
+	return operation_result(TWI_Transfer(DS3231_TWI_BUS, &t));
+}
+
+/* function to transmit data_length registers starting from start_register_address, each value produced by encoder
+   while the previous byte is on the bus, so no buffer is needed */
+uint8_t time_i2c_write_encoded(uint8_t device_address, uint8_t start_register_address, uint8_t data_length, ds3231_encoder encoder, void *context)
+{
+	register_stream stream = {encoder, NULL, context, start_register_address};
+	TWI_Transaction t = {
+		.address = device_address,
+		.header = {start_register_address},
+		.header_length = 1,
+		.write_length = data_length,
+		.stream = &codec_stream,
+		.context = &stream,
+	};
+	return operation_result(TWI_Transfer(DS3231_TWI_BUS, &t));
+}
+
+/* function to read data_length registers starting from start_register_address in one burst,
+   each value handed to decoder as soon as it is received */
+uint8_t time_i2c_read_decoded(uint8_t device_address, uint8_t start_register_address, uint8_t data_length, ds3231_decoder decoder, void *context)
+{
+	register_stream stream = {NULL, decoder, context, start_register_address};
+	TWI_Transaction t = {
+		.address = device_address,
+		.header = {start_register_address},
+		.header_length = 1,
+		.read_length = data_length,
+		.stream = &codec_stream,
+		.context = &stream,
+	};
+	return operation_result(TWI_Transfer(DS3231_TWI_BUS, &t));
 }
 
-/* function to initialize I2C peripheral in 100kHz or 400kHz */
+/* function to initialize the I2C peripheral the ds3231 is wired to (DS3231_TWI_BUS) in 400kHz fast mode, or the bus speed if that is slower */
 void ds3231_I2C_init()
 {
-	TWI_Host_Initialize();
+	/* timekeeping reads go ahead of any queued display traffic on a shared bus */
+	TWI_AddDevice(DS3231_TWI_BUS, DS3231_I2C_ADDRESS, TWI_SPEED_FAST, TWI_PRIORITY_HIGH, TWI_SCHEDULER_UNLIMITED);
+	TWI_Host_Initialize(DS3231_TWI_BUS);
+}
+
+/* called from the TWI interrupt for each payload byte of an encoded write */
+static uint8_t stream_write_byte(TWI_Transaction *t, uint8_t index)
+{
+	register_stream *stream = t->context;
+	return stream->encoder(stream->context, stream->start_register_address + index);
+}
+
+/* called from the TWI interrupt for each byte of a decoded read */
+static void stream_read_byte(TWI_Transaction *t, uint8_t index, uint8_t data)
+{
+	register_stream *stream = t->context;
+	stream->decoder(stream->context, stream->start_register_address + index, data);
 }
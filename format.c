@@ -0,0 +1,50 @@
+/*
+ * format.c
+ *
+ * Created: 10/17/2026 6:40:05 PM
+ *  Author: agpri
+ */
+
+#include "format.h"
+#include "bcd.h"
+#include <avr/pgmspace.h>
+
+// The digits come from the packed BCD of the value, one multiply and shift (see bcd.h)
+char* Format_TwoDigits(char* out, uint8_t value) {
+	uint8_t bcd = BCD_Encode(value);
+	*out++ = '0' + (bcd >> 4);
+	*out++ = '0' + (bcd & 0x0F);
+	return out;
+}
+
+char* Format_Number(char* out, uint8_t value) {
+	uint8_t bcd = BCD_Encode(value);
+	if (bcd >> 4) {
+		*out++ = '0' + (bcd >> 4);
+	}
+	*out++ = '0' + (bcd & 0x0F);
+	return out;
+}
+
+char* Format_Hour(char* out, uint8_t hour, uint8_t twelve_hour) {
+	if (!twelve_hour) {
+		return Format_TwoDigits(out, hour);
+	}
+	uint8_t hour12 = hour % 12;
+	return Format_Number(out, hour12 ? hour12 : 12);
+}
+
+char* Format_String(char* out, const char* str) {
+	while (*str) {
+		*out++ = *str++;
+	}
+	return out;
+}
+
+char* Format_String_P(char* out, const char* str) {
+	char c;
+	while ((c = pgm_read_byte(str++))) {
+		*out++ = c;
+	}
+	return out;
+}
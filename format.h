@@ -0,0 +1,32 @@
+/*
+ * format.h
+ *
+ * Created: 10/17/2026 6:40:05 PM
+ *  Author: agpri
+ *
+ * Fixed layout number and time emitters for the display strings, without stdio.
+ * Each one writes its characters at `out` (no terminating NUL) and returns the
+ * position after them, so a line is built by chaining calls and ending with '\0'.
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdint.h>
+
+// Two digits with a leading zero, value 0-99
+char* Format_TwoDigits(char* out, uint8_t value);
+
+// One or two digits without a leading zero, value 0-99
+char* Format_Number(char* out, uint8_t value);
+
+// Hour of a 0-23 hour: 1-12 without a leading zero if twelve_hour, otherwise two digits
+char* Format_Hour(char* out, uint8_t hour, uint8_t twelve_hour);
+
+// The characters of a string, without its NUL
+char* Format_String(char* out, const char* str);
+
+// The characters of a string in flash (PROGMEM), without its NUL
+char* Format_String_P(char* out, const char* str);
+
+#endif // FORMAT_H
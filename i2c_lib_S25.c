@@ -1,101 +1,435 @@
+#define F_CPU 16000000UL
+
 #include "i2c_lib_S25.h"
-#include <avr/sfr_defs.h>
+#include "twi_scheduler.h"
+#include "twi_profiler.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+#include <stddef.h>
+
+// Maximum rise times from the I2C specification
+#define TWI_RISE_TIME_STANDARD_NS   1000
+#define TWI_RISE_TIME_FAST_NS       300
+#define TWI_RISE_TIME_FAST_PLUS_NS  120
+
+// fSCL = F_CPU / (10 + 2 * BAUD + F_CPU * tRISE), solved for BAUD and rounded up
+// so the bus is never clocked faster than requested
+#define TWI_BAUD(f_scl, t_rise_ns) \
+	(((F_CPU / (f_scl)) - 10 - ((F_CPU / 1000000UL) * (t_rise_ns) / 1000UL) + 1) / 2)
+
+// Half period of the SCL pulses clocked out during bus recovery (100 kHz)
+#define TWI_RECOVERY_HALF_PERIOD_US 5
+#define TWI_RECOVERY_PULSES 9
+
+
+static TWI_Transaction twi0_slots[TWI_SCHEDULER_SLOTS];
+
+TWI_Bus twi_bus0 = {
+	.twi = &TWI0,
+	.port = &TWI0_PORT,
+	.sda = TWI0_SDA,
+	.scl = TWI0_SCL,
+	.speed = TWI0_SPEED,
+	.scheduler = TWI_SCHEDULER_INITIALIZER(twi0_slots),
+};
+
+#ifdef TWI_SEPARATE_BUSES
+static TWI_Transaction twi1_slots[TWI_SCHEDULER_SLOTS];
+
+TWI_Bus twi_bus1 = {
+	.twi = &TWI1,
+	.port = &TWI1_PORT,
+	.sda = TWI1_SDA,
+	.scl = TWI1_SCL,
+	.speed = TWI1_SPEED,
+	.scheduler = TWI_SCHEDULER_INITIALIZER(twi1_slots),
+};
+#endif
+
+// Buses advanced by TWI_Tick
+static TWI_Bus* const buses[] = {
+	&twi_bus0,
+#ifdef TWI_SEPARATE_BUSES
+	&twi_bus1,
+#endif
+};
+
+static TWI_ErrorCounters error_counters[TWI_DEVICE_SLOTS];
+
+// SCL speed of each device slot, set by TWI_AddDevice. A device that was not added
+// runs in standard mode, which every I2C device supports.
+static TWI_Speed device_speeds[TWI_DEVICE_SLOTS];
+
+static void configure_host(TWI_Bus* bus);
+static void set_speed(TWI_t* twi, TWI_Speed speed);
+static void start_next_transaction(TWI_Bus* bus);
+static void send_address(TWI_Bus* bus);
+static void finish_transaction(TWI_Bus* bus, TWI_Status status);
+static uint8_t device_slot(uint8_t address);
+static void count_error(uint8_t slot, TWI_Status status, uint8_t mstatus);
+static void handle_interrupt(TWI_Bus* bus);
+
+void TWI_Host_Initialize(TWI_Bus* bus)
+{
+	if (bus->initialized) {
+		return;
+	}
+	bus->scl_speed = bus->speed;
+	configure_host(bus);
+	bus->initialized = 1;
+	TWI_Profiler_Init();
+}
 
-void TWI_Stop()
+void TWI_AddDevice(TWI_Bus* bus, uint8_t address, TWI_Speed speed, TWI_Priority priority, uint16_t bytes_per_second)
 {
-	TWI0.MCTRLB |= TWI_MCMD_STOP_gc;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		TWI_Scheduler_AddDevice(&bus->scheduler, address, priority, bytes_per_second);
+		uint8_t slot = device_slot(address);
+		if (slot < TWI_DEVICE_SLOTS) {
+			device_speeds[slot] = (speed < bus->speed) ? speed : bus->speed;
+		}
+	}
 }
 
+void TWI_Submit(TWI_Bus* bus, const TWI_Transaction* transaction)
+{
+	// Wait for space, the interrupt frees a slot each time a transaction finishes
+	while (!TWI_TrySubmit(bus, transaction)) { TWI_WAIT_HOOK(); }
+}
 
-void TWI_Host_Initialize()
+uint8_t TWI_TrySubmit(TWI_Bus* bus, const TWI_Transaction* transaction)
 {
-	// Step 1: Set communication rate
-	// SCLK = 80 KHz, Rise Time = 10ns
-	// TWI0.MBAUD = 95;
-	
-	// SCLK = 100 KHz, Rise Time = 10ns
-	TWI0.MBAUD = 70;
-	
-	// Step 2: Enable i2c
-	TWI0.MCTRLA |= TWI_ENABLE_bm;
-	
-	// Step 3: Set initial status to idle
-	TWI0.MSTATUS |= TWI_BUSSTATE_IDLE_gc;
-		
-}
-
-void TWI_Address(uint8_t Address, uint8_t mode)
-{
-	while (1) {
-		// Step 1: Shift Address left by 1
-		uint8_t addressWithMode = Address << 1;
-	
-		// Step bitwise OR address with mode
-		addressWithMode |= mode;
-	
-		// Step 3: Set the Address Register to updated address
-		TWI0.MADDR = addressWithMode;
-	
-		// Step 4: Create a flag variable and set to correct interrupt flag based on mode
-		uint8_t flag;
-		if (mode == TW_WRITE) {
-			flag = TWI_WIF_bp;
+	uint8_t queued = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (!TWI_Scheduler_Full(&bus->scheduler, transaction)) {
+			TWI_Scheduler_Enqueue(&bus->scheduler, transaction);
+			if (transaction->status) {
+				*transaction->status = TWI_STATUS_QUEUED;
+			}
+			if (bus->engine_state == TWI_ENGINE_IDLE) {
+				start_next_transaction(bus);
+			}
+			queued = 1;
 		}
-		else {
-			flag = TWI_RIF_bp;
+	}
+	return queued;
+}
+
+TWI_Status TWI_Wait(volatile TWI_Status* status)
+{
+	while (*status == TWI_STATUS_QUEUED || *status == TWI_STATUS_BUSY) { TWI_WAIT_HOOK(); }
+	return *status;
+}
+
+TWI_Status TWI_Transfer(TWI_Bus* bus, const TWI_Transaction* transaction)
+{
+	volatile TWI_Status status;
+	TWI_Transaction t = *transaction;
+	t.status = &status;
+	TWI_Submit(bus, &t);
+	return TWI_Wait(&status);
+}
+
+uint8_t TWI_Idle(TWI_Bus* bus)
+{
+	return (TWI_Scheduler_Empty(&bus->scheduler) && bus->engine_state == TWI_ENGINE_IDLE);
+}
+
+void TWI_Tick()
+{
+	for (uint8_t i = 0; i < sizeof(buses) / sizeof(buses[0]); i++) {
+		TWI_Bus* bus = buses[i];
+		TWI_Scheduler_Tick(&bus->scheduler);
+
+		if (bus->engine_state == TWI_ENGINE_IDLE) {
+			// Transactions held back by their device budget may be allowed on the bus now
+			start_next_transaction(bus);
+			continue;
 		}
-	            
-		// Step 5: Wait for the flag bit is set
-		loop_until_bit_is_set(TWI0.MSTATUS, flag);
-					
-		// Step 6:  Check if the client acknowledged (ACK) else keep infinite loop going trying to send address
-		// - If acknowledge you can call the STOP
-		if (TWI0.MSTATUS & TWI_RXACK_bm) {
-			TWI_Stop();
+
+		uint8_t timeout = bus->current->timeout_ms ? bus->current->timeout_ms : TWI_DEFAULT_TIMEOUT_MS;
+		if (++bus->elapsed_ms >= timeout) {
+			TWI_Bus_Recover(bus);
+			count_error(bus->slot, TWI_STATUS_TIMEOUT, 0);
+			finish_transaction(bus, TWI_STATUS_TIMEOUT);
 		}
-	
-		// Step 7: Check for errors not there break out of infinite loop both have to be false
-		// - Arbitration Lost if false break infinite loop.
-		// - Bus Error if false break infinite loop
-		if (!(TWI0.MSTATUS & TWI_ARBLOST_bm) && !(TWI0.MSTATUS & TWI_BUSERR_bm)) {
+	}
+}
+
+void TWI_Bus_Recover(TWI_Bus* bus)
+{
+	TWI_t* twi = bus->twi;
+	PORT_t* port = bus->port;
+
+	// Step 1: Disable the host so the port controls the pins, both released high by the pull-ups
+	twi->MCTRLB = TWI_FLUSH_bm;
+	twi->MCTRLA = 0;
+	port->OUTCLR = bus->sda | bus->scl;
+	port->DIRCLR = bus->sda | bus->scl;
+
+	// Step 2: Clock SCL until the client finishes the byte it is sending and releases SDA
+	for (uint8_t i = 0; i < TWI_RECOVERY_PULSES && !(port->IN & bus->sda); i++) {
+		port->DIRSET = bus->scl;
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+		port->DIRCLR = bus->scl;
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	}
+
+	// Step 3: START then STOP (SDA low then high while SCL is high) to reset the clients
+	port->DIRSET = bus->sda;
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	port->DIRCLR = bus->sda;
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+
+	// Step 4: Re-initialize the host and force the bus state to idle
+	configure_host(bus);
+	twi->MSTATUS = TWI_BUSSTATE_IDLE_gc;
+}
+
+const TWI_ErrorCounters* TWI_GetErrorCounters(uint8_t address)
+{
+	for (uint8_t i = 0; i < TWI_DEVICE_SLOTS; i++) {
+		if (error_counters[i].address == address) {
+			return &error_counters[i];
+		}
+	}
+	return NULL;
+}
+
+uint8_t TWI_SlotAddress(uint8_t slot)
+{
+	return slot < TWI_DEVICE_SLOTS ? error_counters[slot].address : 0;
+}
+
+void TWI_ResetErrorCounters()
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for (uint8_t i = 0; i < TWI_DEVICE_SLOTS; i++) {
+			error_counters[i] = (TWI_ErrorCounters) {.address = error_counters[i].address};
+		}
+	}
+}
+
+// Set communication rate, enable the host with read and write interrupts, set bus state to idle
+static void configure_host(TWI_Bus* bus)
+{
+	TWI_t* twi = bus->twi;
+
+	// Step 1: Set communication rate
+	set_speed(twi, bus->scl_speed);
+
+	// Step 2: Enable i2c with read and write interrupts
+	twi->MCTRLA = TWI_ENABLE_bm | TWI_RIEN_bm | TWI_WIEN_bm;
+
+	// Step 3: Set initial status to idle
+	twi->MSTATUS |= TWI_BUSSTATE_IDLE_gc;
+}
+
+// Fm+ also needs the stronger output drivers
+static void set_speed(TWI_t* twi, TWI_Speed speed)
+{
+	switch (speed) {
+		case TWI_SPEED_FAST_PLUS:
+			twi->CTRLA |= TWI_FMPEN_bm;
+			twi->MBAUD = TWI_BAUD(1000000UL, TWI_RISE_TIME_FAST_PLUS_NS);
+			break;
+		case TWI_SPEED_FAST:
+			twi->CTRLA &= ~TWI_FMPEN_bm;
+			twi->MBAUD = TWI_BAUD(400000UL, TWI_RISE_TIME_FAST_NS);
 			break;
+		default:
+			twi->CTRLA &= ~TWI_FMPEN_bm;
+			twi->MBAUD = TWI_BAUD(100000UL, TWI_RISE_TIME_STANDARD_NS);
+			break;
+	}
+}
+
+// Must be called with interrupts disabled
+static void start_next_transaction(TWI_Bus* bus)
+{
+	TWI_Transaction* t = TWI_Scheduler_Next(&bus->scheduler);
+	bus->current = t;
+	if (!t) {
+		bus->engine_state = TWI_ENGINE_IDLE;
+		return;
+	}
+
+	if (t->status) {
+		*t->status = TWI_STATUS_BUSY;
+	}
+	bus->write_index = 0;
+	bus->read_index = 0;
+	bus->address_retries = 0;
+	bus->elapsed_ms = 0;
+	bus->slot = device_slot(t->address);
+
+	// Switch SCL to the device's speed. The previous transaction has ended with its STOP,
+	// so the host is idle and the new rate applies from the START.
+	TWI_Speed speed = (bus->slot < TWI_DEVICE_SLOTS) ? device_speeds[bus->slot] : TWI_SPEED_STANDARD;
+	if (speed != bus->scl_speed) {
+		bus->scl_speed = speed;
+		set_speed(bus->twi, speed);
+	}
+
+	TWI_Profiler_Start(bus->slot);
+	send_address(bus);
+}
+
+// Writing MADDR generates a START, or a repeated START if the host already owns the bus
+static void send_address(TWI_Bus* bus)
+{
+	TWI_Transaction* t = bus->current;
+	TWI_Profiler_Byte(bus->slot);
+	if (bus->write_index < t->header_length + t->write_length) {
+		bus->engine_state = TWI_ENGINE_WRITE;
+		bus->twi->MADDR = (t->address << 1) | TW_WRITE;
+	}
+	else {
+		bus->engine_state = TWI_ENGINE_READ;
+		bus->twi->MADDR = (t->address << 1) | TW_READ;
+	}
+}
+
+static void finish_transaction(TWI_Bus* bus, TWI_Status status)
+{
+	TWI_Transaction* t = bus->current;
+	TWI_Profiler_Stop(bus->slot);
+	if (t->status) {
+		*t->status = status;
+	}
+	if (t->callback) {
+		t->callback(t);
+	}
+	TWI_Scheduler_Complete(&bus->scheduler);
+	start_next_transaction(bus);
+}
+
+// Counter slot of `address`, taking a free slot the first time, or TWI_DEVICE_SLOTS if all are taken.
+// Address 0 is the general call address and is never used by a transaction, so it marks a free slot.
+// Looked up once per transaction, the error and traffic counters are indexed by the slot.
+static uint8_t device_slot(uint8_t address)
+{
+	for (uint8_t i = 0; i < TWI_DEVICE_SLOTS; i++) {
+		if (error_counters[i].address == address || error_counters[i].address == 0) {
+			error_counters[i].address = address;
+			return i;
 		}
 	}
-	
-	
+	return TWI_DEVICE_SLOTS;
+}
+
+// Counts an error against a device slot where it happens on the bus, so a NACK that is
+// retried counts too. For TWI_STATUS_ERROR, `mstatus` is TWIn.MSTATUS.
+static void count_error(uint8_t slot, TWI_Status status, uint8_t mstatus)
+{
+	if (slot >= TWI_DEVICE_SLOTS) {
+		return;
+	}
 
+	TWI_ErrorCounters* counters = &error_counters[slot];
+	switch (status) {
+		case TWI_STATUS_NACK:
+			counters->nacks++;
+			break;
+		case TWI_STATUS_ERROR:
+			if (mstatus & TWI_ARBLOST_bm) {
+				counters->arbitration_lost++;
+			}
+			if (mstatus & TWI_BUSERR_bm) {
+				counters->bus_errors++;
+			}
+			break;
+		case TWI_STATUS_TIMEOUT:
+			counters->timeouts++;
+			break;
+		default:
+			break;
+	}
 }
 
-int TWI_Transmit_Data(uint8_t data) 
+static void handle_interrupt(TWI_Bus* bus)
 {
-	// Step 1: Write data to the register
-	TWI0.MDATA = data;
-	
-	// Step 2: Wait for the Write Interrupt Flag to be set
-	loop_until_bit_is_set(TWI0.MSTATUS, TWI_WIF_bp);
-	
-	// Step 3: Check for errors after the flag is set two errors to check include:
-	// - Arbitration Lost return -1
-	// - Bus Error return -1
-	// - Otherwise, return 0 for success
-	if (TWI0.MSTATUS & TWI_ARBLOST_bm || TWI0.MSTATUS & TWI_BUSERR_bm) {
-		return -1;
+	TWI_t* twi = bus->twi;
+	uint8_t status = twi->MSTATUS;
+	TWI_Transaction* t = bus->current;
+
+	// Arbitration lost or bus error: clear the flags and give up on this transaction
+	if (status & (TWI_ARBLOST_bm | TWI_BUSERR_bm)) {
+		twi->MSTATUS = TWI_ARBLOST_bm | TWI_BUSERR_bm | TWI_RIF_bm | TWI_WIF_bm;
+		count_error(bus->slot, TWI_STATUS_ERROR, status);
+		finish_transaction(bus, TWI_STATUS_ERROR);
+		return;
 	}
-	
-	return 0;
+
+	if (status & TWI_WIF_bm) {
+		// Client did not acknowledge. A NACKed read address also ends up here.
+		if (status & TWI_RXACK_bm) {
+			count_error(bus->slot, TWI_STATUS_NACK, 0);
+			uint8_t on_address = (bus->engine_state == TWI_ENGINE_READ || bus->write_index == 0);
+			if (on_address && bus->address_retries < TWI_ADDRESS_RETRIES) {
+				bus->address_retries++;
+				send_address(bus);
+				return;
+			}
+			twi->MCTRLB = TWI_MCMD_STOP_gc;
+			finish_transaction(bus, TWI_STATUS_NACK);
+			return;
+		}
+
+		// Send the next header or payload byte
+		if (bus->write_index < t->header_length) {
+			TWI_Profiler_Byte(bus->slot);
+			twi->MDATA = t->header[bus->write_index++];
+			return;
+		}
+		if (bus->write_index < t->header_length + t->write_length) {
+			uint8_t index = bus->write_index++ - t->header_length;
+			TWI_Profiler_Byte(bus->slot);
+			twi->MDATA = t->stream ? t->stream->write_byte(t, index) : t->write_data[index];
+			return;
+		}
+
+		// Write phase complete, repeated START into the read phase or STOP
+		if (t->read_length > 0) {
+			send_address(bus);
+			return;
+		}
+		twi->MCTRLB = TWI_MCMD_STOP_gc;
+		finish_transaction(bus, TWI_STATUS_DONE);
+		return;
+	}
+
+	if (status & TWI_RIF_bm) {
+		uint8_t data = twi->MDATA;
+		if (t->stream) {
+			t->stream->read_byte(t, bus->read_index, data);
+		}
+		else {
+			t->read_data[bus->read_index] = data;
+		}
+		bus->read_index++;
+		TWI_Profiler_Byte(bus->slot);
+		if (bus->read_index < t->read_length) {
+			// ACK and receive the next byte
+			twi->MCTRLB = TWI_MCMD_RECVTRANS_gc;
+		}
+		else {
+			// NACK the last byte and release the bus
+			twi->MCTRLB = TWI_ACKACT_bm | TWI_MCMD_STOP_gc;
+			finish_transaction(bus, TWI_STATUS_DONE);
+		}
+	}
+}
+
+ISR(TWI0_TWIM_vect)
+{
+	handle_interrupt(&twi_bus0);
 }
 
-uint8_t TWI_Receive_Data()
+#ifdef TWI_SEPARATE_BUSES
+ISR(TWI1_TWIM_vect)
 {
-	// Step 1: Wait until the Read Interrupt Flag (RIF) is set
-	loop_until_bit_is_set(TWI0.MSTATUS, TWI_RIF_bp);
-	
-	// Step 2: Read data register into a variable to hold data
-	uint8_t data = TWI0.MDATA;
-	
-	// Step 3: Respond with NACK
-	TWI0.MCTRLB |= TWI_ACKACT_bm;
-	
-	// Step 4: return data
-	return data;
+	handle_interrupt(&twi_bus1);
 }
+#endif
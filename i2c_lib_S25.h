@@ -1,121 +1,189 @@
 #ifndef I2C_H
 #define I2C_H
 
-#include <avr/io.h>  
+#include <avr/io.h>
 #include <util//twi.h>
+#include "twi_scheduler.h"
 
-// Define the I2C pins
-#define I2C_PORT     PORTA
-#define I2C_SDA      PIN2_bm
-#define I2C_SCL      PIN3_bm
 #define TW_WRITE     0
 #define TW_READ      1
 
-void TWI_Stop();
-
-void TWI_Host_Initialize();
-    /*
-        Pseudo Code
-            Step 1: Set communication rate 
-                -Given 
-                    - SCLK = 80KHz 
-                    - Rise Time = 10ns
-
-
-
-            Step 2: Enable i2c
-
-
-
-            Step 3: Set initial status to idle
-
-            
-    */
-
-
-void TWI_Address(uint8_t Address, uint8_t mode);
-   /*
-        Psuedo Code
-            Step 1: Shift Address left by 1
-
-
-            Step 2: bitwise OR address with mode
-
-
-
-            Step 3: Set the Address Register to updated address
-
-
-            Step 4: Create a flag variable and set to correct interrupt flag based on mode
-                - uint8_t flag;
-                - check mode 0 = Read and 1 = Write
-                - what interrupt flag would we use
-
-
-
-            Step 5: Wait for the flag bit is set
-            Use which works for you:
-                - loop_until_bit_is_set(TWI0.MSTATUS, flag);
-                - while(TWI0.MSTATUS & flag){}
-
-
-            Step 6: Check if the client acknowledged (ACK) else keep infinite loop going trying to send address
-                - If acknowledge you can call the STOP
-
-
-            Step 7: Check for errors not there break out of infinite loop both have to be false
-                - Arbitration Lost if false break infinite loop.
-                - Bus Error if false break infinite loop
-
-
-    */
-
-
-int TWI_Transmit_Data(uint8_t data);
-    /*
-        Pseudo Code:
-            Step 1: Start the data transfer by writing the data to register
-
-
-            Step 2: Wait for the Write Interrupt Flag (WIF) to be set
-            Use which works for you:
-                - loop_until_bit_is_set(TWI0.MSTATUS, TWI_WIF_bp);
-                - while(TWI0.MSTATUS & TWI_WIF_bp){}
-
-
-
-            Step 3: Check for errors after the flag is set two errors to check include:
-                - Arbitration Lost if true return -1.
-                - Bus Error if true return -1
-                - Otherwise, return 0 to indicate success.
-
-
-    */
-
-
-
-uint8_t TWI_Receive_Data();
-    /*
-        Pseudo Code:
-            Step 1: Wait until the Read Interrupt Flag (RIF) is set 
-            Use which works for you:
-                - loop_until_bit_is_set(TWI0.MSTATUS, TWI_RIF_bp);
-                - while(TWI0.MSTATUS & TWI_RIF_bp){}
-
-
-            Step 2: Read data register into a variable to hold data
-                - uint8_t data
-
-
-            Step 3:  Respond with NACK 
-                - TWI_ACKACT_bm
-
-
-            Step 4: return data
-
-
-    */
-
-#endif 
-
-
+// Number of times a NACKed address is repeated before the transaction fails
+#define TWI_ADDRESS_RETRIES     3
+
+// Time a transaction may take, in 1 ms ticks, when it does not set its own timeout
+#define TWI_DEFAULT_TIMEOUT_MS  10
+
+// Number of devices that get their own error counters (and traffic counters with TWI_PROFILE)
+#define TWI_DEVICE_SLOTS        4
+
+// Maximum number of bytes copied into the queue ahead of the payload
+// (register address, LCD control byte + command + control byte of a data run, ...)
+#define TWI_MAX_HEADER_LENGTH   3
+
+// Runs on each pass of the loops that wait for the bus. Empty on the target,
+// the host simulator uses it to play the bus forward.
+#ifndef TWI_WAIT_HOOK
+#define TWI_WAIT_HOOK()
+#endif
+
+// SCL frequency profiles. MBAUD is computed from F_CPU, the SCL frequency
+// and the maximum rise time the I2C specification allows for the mode.
+typedef enum {
+	TWI_SPEED_STANDARD,	// 100 kHz
+	TWI_SPEED_FAST,		// 400 kHz
+	TWI_SPEED_FAST_PLUS,	// 1 MHz, only if every device on the bus supports Fm+
+} TWI_Speed;
+
+// Bus wiring. By default the DS3231 and the LCD share TWI0 on PA2 (SDA) / PA3 (SCL).
+// Define TWI_SEPARATE_BUSES for boards with the LCD and its backlight on TWI1,
+// PF2 (SDA) / PF3 (SCL): RTC reads then no longer wait behind display writes.
+#define TWI0_PORT               PORTA
+#define TWI0_SDA                PIN2_bm
+#define TWI0_SCL                PIN3_bm
+#define TWI1_PORT               PORTF
+#define TWI1_SDA                PIN2_bm
+#define TWI1_SCL                PIN3_bm
+
+// Fastest speed of each bus. A transaction runs at the speed of its device (TWI_AddDevice),
+// so the DS3231 gets fast mode on TWI0 while the LCD's transactions run in standard mode.
+#define TWI0_SPEED              TWI_SPEED_FAST
+#define TWI1_SPEED              TWI_SPEED_STANDARD
+
+// Bus each driver is bound to
+#define DS3231_TWI_BUS          (&twi_bus0)
+#ifdef TWI_SEPARATE_BUSES
+#define LCD_TWI_BUS             (&twi_bus1)
+#else
+#define LCD_TWI_BUS             (&twi_bus0)
+#endif
+
+typedef enum {
+	TWI_STATUS_QUEUED,	// waiting in the queue
+	TWI_STATUS_BUSY,	// currently on the bus
+	TWI_STATUS_DONE,	// completed successfully
+	TWI_STATUS_NACK,	// client did not acknowledge
+	TWI_STATUS_ERROR,	// arbitration lost or bus error
+	TWI_STATUS_TIMEOUT,	// did not complete before its deadline, the bus was recovered
+} TWI_Status;
+
+struct TWI_Transaction;
+
+// Completion callback. Runs in the TWI interrupt, so it must be short.
+typedef void (*TWI_Callback)(struct TWI_Transaction* transaction);
+
+// Produces and consumes the payload one byte at a time, in place of write_data and read_data,
+// so data can be converted as it goes over the bus instead of through a buffer.
+// Runs in the TWI interrupt, so it must be short. `index` counts payload bytes from 0.
+typedef struct {
+	uint8_t (*write_byte)(struct TWI_Transaction* transaction, uint8_t index);	// next byte to send
+	void (*read_byte)(struct TWI_Transaction* transaction, uint8_t index, uint8_t data);	// byte received
+} TWI_Stream;
+
+/*
+ * One bus transaction: START, address+W, header, write payload,
+ * then optionally repeated START, address+R and read payload, then STOP.
+ * - The header is copied into the queue, so it may live on the stack.
+ * - write_data and read_data are used in place and must stay valid
+ *   until the transaction completes. If stream is set, its functions are
+ *   called for each payload byte instead.
+ * - If write is empty (header_length and write_length are 0) the
+ *   transaction starts directly with address+R.
+ */
+typedef struct TWI_Transaction {
+	uint8_t address;                          // 7-bit client address
+	uint8_t header[TWI_MAX_HEADER_LENGTH];
+	uint8_t header_length;
+	const uint8_t* write_data;
+	uint8_t write_length;
+	uint8_t* read_data;
+	uint8_t read_length;
+	const TWI_Stream* stream;                 // optional, replaces write_data and read_data
+	volatile TWI_Status* status;              // optional, updated as the transaction progresses
+	TWI_Callback callback;                    // optional, called on completion
+	void* context;                            // passed through to the callback and the stream
+	uint8_t timeout_ms;                       // deadline from the start of the transaction, 0 for TWI_DEFAULT_TIMEOUT_MS
+} TWI_Transaction;
+
+typedef enum {
+	TWI_ENGINE_IDLE,
+	TWI_ENGINE_WRITE,	// address+W or a write byte is on the bus
+	TWI_ENGINE_READ,	// address+R or a read byte is on the bus
+} TWI_EngineState;
+
+// One TWI host peripheral, its pins, its transaction queues and the state of the transaction on it
+typedef struct {
+	TWI_t* twi;
+	PORT_t* port;
+	uint8_t sda;
+	uint8_t scl;
+	TWI_Speed speed;			// fastest speed of the bus, see TWI_AddDevice
+	TWI_Speed scl_speed;			// speed MBAUD is set to, that of the last transaction's device
+	uint8_t initialized;
+	TWI_Scheduler scheduler;
+	TWI_Transaction* current;		// transaction on the bus, owned by the scheduler
+	uint8_t slot;				// counter slot of the current transaction's device, TWI_DEVICE_SLOTS if none
+	volatile TWI_EngineState engine_state;
+	uint8_t write_index;			// bytes of header + write payload sent so far
+	uint8_t read_index;			// bytes of read payload received so far
+	uint8_t address_retries;
+	volatile uint8_t elapsed_ms;		// time the current transaction has been on the bus
+} TWI_Bus;
+
+extern TWI_Bus twi_bus0;
+#ifdef TWI_SEPARATE_BUSES
+extern TWI_Bus twi_bus1;
+#endif
+
+typedef struct {
+	uint8_t address;
+	uint16_t nacks;			// every NACK, also of an address that is then retried
+	uint16_t arbitration_lost;
+	uint16_t bus_errors;
+	uint16_t timeouts;
+} TWI_ErrorCounters;
+
+// Set communication rate, enable the host and its interrupts, set bus state to idle.
+// Does nothing if the bus is already initialized, so each driver on a bus can call it.
+// Interrupts must be enabled globally before waiting on any transaction.
+void TWI_Host_Initialize(TWI_Bus* bus);
+
+// Assign a device on the bus its SCL speed, priority class and bus budget (see twi_scheduler.h).
+// Each transaction runs at its device's speed, capped at the bus speed.
+void TWI_AddDevice(TWI_Bus* bus, uint8_t address, TWI_Speed speed, TWI_Priority priority, uint16_t bytes_per_second);
+
+// Add a transaction to its device's priority queue on the bus and start the bus if it is idle.
+// If the queue is full, waits until a slot is free.
+void TWI_Submit(TWI_Bus* bus, const TWI_Transaction* transaction);
+
+// Same as TWI_Submit, but returns 0 instead of waiting if the queue is full, so it can be used
+// from an interrupt. Returns 1 if the transaction was queued.
+uint8_t TWI_TrySubmit(TWI_Bus* bus, const TWI_Transaction* transaction);
+
+// Wait until a transaction reporting to `status` has completed and return its result.
+TWI_Status TWI_Wait(volatile TWI_Status* status);
+
+// Submit a transaction and wait for it to complete.
+TWI_Status TWI_Transfer(TWI_Bus* bus, const TWI_Transaction* transaction);
+
+// Returns 1 if the bus's queues are empty and no transaction is on it.
+uint8_t TWI_Idle(TWI_Bus* bus);
+
+// Advances transaction deadlines on every bus. Call from the 1 ms timer interrupt.
+void TWI_Tick();
+
+// Frees a stuck bus: clocks SCL until the client releases SDA, sends a STOP,
+// then re-initializes the host and forces the bus state to idle.
+void TWI_Bus_Recover(TWI_Bus* bus);
+
+// Returns the error counters of a 7-bit address, or NULL if it has not been on the bus.
+const TWI_ErrorCounters* TWI_GetErrorCounters(uint8_t address);
+
+// Returns the address of the device in a counter slot, 0 if the slot is free.
+// A device keeps its slot once it has been on the bus.
+uint8_t TWI_SlotAddress(uint8_t slot);
+
+// Clears all error counters, the devices keep their slots
+void TWI_ResetErrorCounters();
+
+#endif
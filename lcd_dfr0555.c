@@ -8,107 +8,441 @@
 
 #include "lcd_dfr0555.h"
 #include "i2c_lib_S25.h"
-#include <util/delay.h>
+#include "backlight.h"
+#include <util/atomic.h>
+#include <avr/pgmspace.h>
+#include <stddef.h>
 #include <string.h>
 
 #define LCD_ADDRESS		  0x3E
-#define BACKLIGHT_ADDRESS 0x6B
 #define LCD_DATA_CTRL 0x40
 #define LCD_CMD_CTRL 0x00
+#define LCD_CONTINUE 0x80	// Co bit of a control byte: another control byte follows the next byte.
+				// Without it, every byte up to the STOP is data (or commands) for the same control byte
 
+// Bus budget in bytes per second. A full two line redraw is 40 bytes,
+// so the LCD can still redraw 50 times a second while the pot is turned.
+#define LCD_BUS_BUDGET        2048
 
+// A run of changed cells is extended over up to this many unchanged cells rather than
+// starting a new run, which costs the address byte, a cursor command and two control bytes
+#define LCD_FLUSH_MAX_GAP     4
 
-// Send command to LCD
+// What the application wants on the display, and what was last sent to DDRAM
+static char frame[LCD_LINES][LCD_COLUMNS];
+static char ddram[LCD_LINES][LCD_COLUMNS];
+static uint16_t dirty[LCD_LINES];	// bit n set if frame and ddram differ in column n
+#define DIRTY_BIT(column) ((uint16_t)1u << (column))
+static uint8_t frame_column;
+static uint8_t frame_line;
+static uint8_t ddram_address;		// where the LCD's address counter points, LCD_ADDRESS_UNKNOWN if not known
+#define LCD_ADDRESS_UNKNOWN 0xFF
+static uint8_t cursor_address;		// cell the cursor is shown on, LCD_ADDRESS_UNKNOWN if hidden
+
+// Other displays that get the runs LCD_flush sends
+static LCD_Sink sinks[LCD_SINKS];
+
+// Time the controller is busy after an instruction, in 1 ms ticks.
+// A countdown of n ticks lasts at least n - 1 ms.
+#define LCD_POWER_UP_TICKS      (50 + 1)	// from power on to the first instruction, at least 40 ms
+#define LCD_SLOW_COMMAND_TICKS  (2 + 1)		// clear display and return home, 1.53 ms
+// Every other instruction takes 39 us (43 us for data), less than the next byte takes at the
+// LCD's standard mode SCL (90 us, see LCD_init), so those are sent back to back
+
+#define LCD_COMMAND_QUEUE_LENGTH 8
+
+// Each line of DDRAM is 40 characters, of which the display shows a 16 character window
+#define LCD_DDRAM_LINE_LENGTH 40
+
+// Time between marquee steps, one display shift command each
+#define LCD_MARQUEE_STEP_MS 400
+#define LCD_SHIFT_DISPLAY_LEFT 0b00011000
+#define LCD_RETURN_HOME 0b00000010
+
+// An LCD transaction waiting for the controller to be ready
+typedef struct {
+	uint8_t header[TWI_MAX_HEADER_LENGTH];
+	uint8_t header_length;
+	const uint8_t* data;
+	uint8_t length;
+	uint8_t settle_ticks;	// time the controller is busy after the transaction
+} LCD_Write;
+
+// Glyph in each CGRAM slot, NULL if the slot is free
+static const uint8_t* glyphs[LCD_GLYPH_SLOTS];
+static uint8_t oldest_glyph;
+
+// Marquee: a whole DDRAM line of text that the display window scrolls over
+static char marquee_text[LCD_DDRAM_LINE_LENGTH];
+static const char marquee_blanks[LCD_DDRAM_LINE_LENGTH - LCD_COLUMNS] = "                        ";
+static volatile uint8_t marquee_active;
+static uint8_t marquee_line;
+static uint16_t marquee_ms;
+
+static LCD_Write commands[LCD_COMMAND_QUEUE_LENGTH];
+static volatile uint8_t command_head;
+static volatile uint8_t command_count;
+static volatile uint8_t settle_ticks;	// ticks until the controller accepts the next instruction
+static volatile uint8_t settling;	// a slow instruction is on the bus, settle_ticks is set when it completes
+
+static void enqueue(const LCD_Write* write);
+static void print_line(const char* str, uint8_t in_flash, uint8_t line, uint8_t centered);
+static void start_marquee(const char* str, uint8_t in_flash, uint8_t line);
+static uint8_t try_enqueue(const LCD_Write* write);
+static void dispatch();
+static void start_settling(TWI_Transaction* t);
+static uint8_t ready();
+static uint8_t command_settle_ticks(uint8_t cmd);
+static void run_header(LCD_Write* write, uint8_t with_command, uint8_t cmd);
+static void put_char(char c);
+static uint8_t cell_address(uint8_t column, uint8_t line);
+
+
+// Queue a two byte write (control/register byte + value) to a device on the bus
+static void write_pair(uint8_t address, uint8_t first, uint8_t second) {
+	TWI_Transaction t = {
+		.address = address,
+		.header = {first, second},
+		.header_length = 2,
+	};
+	TWI_Submit(LCD_TWI_BUS, &t);
+}
+
+// Send command to LCD, once the instructions queued ahead of it have executed
 void LCD_command(uint8_t cmd) {
-	TWI_Address(LCD_ADDRESS, TW_WRITE);
-	TWI_Transmit_Data(LCD_CMD_CTRL); 
-	TWI_Transmit_Data(cmd);
-	TWI_Stop();
+	LCD_Write write = {
+		.header = {LCD_CMD_CTRL, cmd},
+		.header_length = 2,
+		.settle_ticks = command_settle_ticks(cmd),
+	};
+	enqueue(&write);
+	ddram_address = LCD_ADDRESS_UNKNOWN;
 }
 
-// Send one character to LCD
+// Send one character to LCD at its current address, bypassing the framebuffer
 void LCD_data(uint8_t data) {
-	TWI_Address(LCD_ADDRESS, TW_WRITE);
-	TWI_Transmit_Data(LCD_DATA_CTRL); // Control byte for data
-	TWI_Transmit_Data(data);
-	TWI_Stop();
+	LCD_Write write = {
+		.header = {LCD_DATA_CTRL, data}, // Control byte for data
+		.header_length = 2,
+	};
+	enqueue(&write);
+	ddram_address = LCD_ADDRESS_UNKNOWN;
+}
+
+// Send characters to LCD at its current address in one transaction, bypassing the framebuffer
+void LCD_data_run(const uint8_t* data, uint8_t length) {
+	LCD_Write write = {
+		.data = data,
+		.length = length,
+	};
+	run_header(&write, 0, 0);
+	enqueue(&write);
+	ddram_address = LCD_ADDRESS_UNKNOWN;
+}
+
+// Send a command followed by characters to LCD in one transaction, bypassing the framebuffer
+void LCD_command_data_run(uint8_t cmd, const uint8_t* data, uint8_t length) {
+	LCD_Write write = {
+		.data = data,
+		.length = length,
+		.settle_ticks = command_settle_ticks(cmd),
+	};
+	run_header(&write, 1, cmd);
+	enqueue(&write);
+	ddram_address = LCD_ADDRESS_UNKNOWN;
 }
 
 // Write to backlight
 void LCD_backlight_write(uint8_t cmd, uint8_t data) {
-	TWI_Address(BACKLIGHT_ADDRESS, TW_WRITE);
-	TWI_Transmit_Data(cmd); 
-	TWI_Transmit_Data(data);
-	TWI_Stop();
+	write_pair(BACKLIGHT_ADDRESS, cmd, data);
+}
+
+// Sends queued LCD writes once the controller is ready for them. Call from the 1 ms timer interrupt.
+void LCD_tick() {
+	if (settle_ticks) {
+		settle_ticks--;
+	}
+	if (marquee_active && ++marquee_ms >= LCD_MARQUEE_STEP_MS) {
+		LCD_Write shift = {
+			.header = {LCD_CMD_CTRL, LCD_SHIFT_DISPLAY_LEFT},
+			.header_length = 2,
+		};
+		// If the queue is full the step is taken on the next tick
+		if (try_enqueue(&shift)) {
+			marquee_ms = 0;
+		}
+	}
+	dispatch();
 }
 
-// Initialize LCD (2-line, 5x8 dots, display on, clear).
-// TWI_Host_Initialize must be called first.
+// Initialize LCD (2-line, 5x8 dots, display on, clear) and the bus it is on (LCD_TWI_BUS).
+// Returns right away, the commands are sent in the background once the LCD has powered up.
 void LCD_init() {
-	LCD_display_on_off(1, 0, 0);
-	_delay_us(39);
+	// LCD writes can be overtaken by RTC reads between transactions. Standard mode even on a
+	// fast bus: a data run streams a character every 9 SCL cycles, 22.5 us in fast mode.
+	TWI_AddDevice(LCD_TWI_BUS, LCD_ADDRESS, TWI_SPEED_STANDARD, TWI_PRIORITY_NORMAL, LCD_BUS_BUDGET);
+	TWI_Host_Initialize(LCD_TWI_BUS);
+	
+	settle_ticks = LCD_POWER_UP_TICKS;
 	// LCD 2-line on
 	LCD_command(0b00101000);	// Function set: 8-bit, 2-line, 5x8 dots
-	_delay_us(39);
-	//Reset Register for Backlight
-	LCD_backlight_write(0x2F, 0x00);
-	//Shutdown Register Write
-	LCD_backlight_write(0x00, 0b00100000);
-	//PWM Register Write to Full Blue
-	LCD_backlight_write(0x04, 0xFF);
-	// Send Update PWM
-	LCD_backlight_write(0x07, 0x00);
+	LCD_display_on_off(1, 0, 0);
+	LCD_command(0b00000001);	// Clear display, also the DDRAM past the 16 visible columns
+	
+	marquee_active = 0;
+	cursor_address = LCD_ADDRESS_UNKNOWN;
+	
+	// CGRAM is not cleared and holds nothing known after power up
+	memset(glyphs, 0, sizeof(glyphs));
+	oldest_glyph = 0;
+	
+	// The clear leaves every cell blank and the address counter at 0
+	memset(ddram, ' ', sizeof(ddram));
+	memset(dirty, 0, sizeof(dirty));
+	ddram_address = cell_address(0, 0);
+	LCD_clear();
+	
+	Backlight_Init();
 }
 
 // Print a string to LCD
 void LCD_print(const char* str) {
 	while (*str) {
-		LCD_data(*str++);
+		put_char(*str++);
+	}
+}
+
+void LCD_print_P(const char* str) {
+	char c;
+	while ((c = pgm_read_byte(str++))) {
+		put_char(c);
 	}
 }
 
 // Print a string to LCD on a given line
 void LCD_printline(const char* str, uint8_t line) {
-	size_t len = strlen(str);
-	LCD_set_cursor(0, line);
-	while (*str) {
-		LCD_data(*str++);
+	print_line(str, 0, line, 0);
+}
+
+void LCD_printline_P(const char* str, uint8_t line) {
+	print_line(str, 1, line, 0);
+}
+
+// Print a string to LCD centered on a given line
+void LCD_printline_centered(const char* str, uint8_t line) {
+	print_line(str, 0, line, 1);
+}
+
+void LCD_printline_centered_P(const char* str, uint8_t line) {
+	print_line(str, 1, line, 1);
+}
+
+// Show a string of up to 40 characters on a line. A string longer than the line is written
+// to the whole 40 character DDRAM line once, then the display window is shifted over it
+// one character per LCD_MARQUEE_STEP_MS, a single command per step.
+// The controller shifts both lines together, so the other line scrolls along and its
+// DDRAM past the visible columns is blanked. Printing to the marquee's line or calling
+// LCD_marquee_stop ends it and brings the window back.
+void LCD_printline_marquee(const char* str, uint8_t line) {
+	start_marquee(str, 0, line);
+}
+
+void LCD_printline_marquee_P(const char* str, uint8_t line) {
+	start_marquee(str, 1, line);
+}
+
+// `str` is in flash if `in_flash`
+static void start_marquee(const char* str, uint8_t in_flash, uint8_t line) {
+	size_t len = in_flash ? strlen_P(str) : strlen(str);
+	if (len <= LCD_COLUMNS) {
+		LCD_marquee_stop();
+		print_line(str, in_flash, line, 1);
+		return;
 	}
-	for (size_t i = len; i < 16; i++) {
-		LCD_data(' ');
+	if (len > LCD_DDRAM_LINE_LENGTH) {
+		len = LCD_DDRAM_LINE_LENGTH;
+	}
+	LCD_marquee_stop();
+	
+	// Whatever the framebuffer holds for the visible part of the line goes first,
+	// the marquee text overwrites it in DDRAM
+	LCD_flush();
+	memset(marquee_text, ' ', sizeof(marquee_text));
+	if (in_flash) {
+		memcpy_P(marquee_text, str, len);
+	}
+	else {
+		memcpy(marquee_text, str, len);
+	}
+	LCD_command_data_run(0b10000000 | cell_address(0, line), (const uint8_t*)marquee_text, sizeof(marquee_text));
+	LCD_command_data_run(0b10000000 | cell_address(LCD_COLUMNS, !line), (const uint8_t*)marquee_blanks, sizeof(marquee_blanks));
+	
+	// The visible columns of the line now hold the start of the text
+	memcpy(frame[line], marquee_text, LCD_COLUMNS);
+	memcpy(ddram[line], marquee_text, LCD_COLUMNS);
+	dirty[line] = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		marquee_line = line;
+		marquee_ms = 0;
+		marquee_active = 1;
 	}
 }
 
-// Print a string to LCD on a given line
-void LCD_printline_centered(const char* str, uint8_t line) {
-	size_t len = strlen(str);
-	size_t leftpad = 0;
-	size_t rightpad = 0;
-	if (len < 16) {
-		leftpad = (16 - len) / 2;
-		rightpad = 16 - len - leftpad;
+// Stop the marquee and shift the display window back to the start of the lines
+void LCD_marquee_stop() {
+	uint8_t was_active;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		was_active = marquee_active;
+		marquee_active = 0;
 	}
-	LCD_set_cursor(0, line);
-	for (size_t i = 0; i < leftpad; i++) {
-		LCD_data(' ');
+	if (was_active) {
+		LCD_command(LCD_RETURN_HOME);
 	}
-	while (*str) {
-		LCD_data(*str++);
+}
+
+// The LCD draws its cursor at the address counter, which moves with every character written.
+// The cursor cell is kept here and LCD_flush puts the address counter back on it.
+void LCD_cursor(uint8_t column, uint8_t line) {
+	if (cursor_address == LCD_ADDRESS_UNKNOWN) {
+		LCD_display_on_off(1, 1, 1);
 	}
-	for (size_t i = 0; i < rightpad; i++) {
-		LCD_data(' ');
+	cursor_address = cell_address(column, line);
+}
+
+void LCD_cursor_off() {
+	if (cursor_address != LCD_ADDRESS_UNKNOWN) {
+		LCD_display_on_off(1, 0, 0);
+		cursor_address = LCD_ADDRESS_UNKNOWN;
 	}
 }
 
+// Clear LCD. Only the framebuffer is cleared, the next flush blanks the cells that were in use
 void LCD_clear(void){
-	LCD_command(0x01);
-	_delay_ms(1.53);
+	for (uint8_t line = 0; line < LCD_LINES; line++) {
+		LCD_clearline(line);
+	}
+	LCD_set_cursor(0, 0);
+}
+
+// Clear a line of the LCD
+void LCD_clearline(uint8_t line) {
+	LCD_set_cursor(0, line);
+	for (uint8_t i = 0; i < LCD_COLUMNS; i++) {
+		put_char(' ');
+	}
+	LCD_set_cursor(0, line);
+}
+
+// Set the position the next print writes to in the framebuffer
+void LCD_set_cursor(uint8_t column, uint8_t line) {
+	frame_column = column;
+	frame_line = line;
+}
+
+// Send the cells that changed since the last flush. A run of changed cells costs one
+// cursor command, which is left out when the LCD's address counter is already there.
+// While the LCD is busy with a slow command the changes stay in the framebuffer.
+// If the cursor is shown, one more command moves the address counter back to its cell.
+void LCD_flush() {
+	// Nothing changed and the cursor is in place
+	if (!(dirty[0] | dirty[1]) && (cursor_address == LCD_ADDRESS_UNKNOWN || ddram_address == cursor_address)) {
+		return;
+	}
+	if (!ready()) {
+		return;
+	}
+	for (uint8_t line = 0; line < LCD_LINES; line++) {
+		uint8_t column = 0;
+		while (column < LCD_COLUMNS && (dirty[line] >> column)) {
+			if (!(dirty[line] & DIRTY_BIT(column))) {
+				column++;
+				continue;
+			}
+			
+			// Extend the run to the last changed cell that is at most LCD_FLUSH_MAX_GAP cells after the previous one
+			uint8_t end = column;
+			for (uint8_t next = column + 1; next < LCD_COLUMNS && next <= end + LCD_FLUSH_MAX_GAP + 1; next++) {
+				if (dirty[line] & DIRTY_BIT(next)) {
+					end = next;
+				}
+			}
+			
+			// The run is sent from ddram in place. If a later flush changes these cells before the
+			// run is on the bus, the newer characters go out twice, which leaves the same display.
+			uint8_t address = cell_address(column, line);
+			uint8_t length = end + 1 - column;
+			memcpy(&ddram[line][column], &frame[line][column], length);
+			LCD_Write write = {
+				.data = (const uint8_t*)&ddram[line][column],
+				.length = length,
+			};
+			run_header(&write, ddram_address != address, 0b10000000 | address);
+			enqueue(&write);
+			for (uint8_t i = 0; i < LCD_SINKS; i++) {
+				if (sinks[i]) {
+					sinks[i](column, line, &ddram[line][column], length);
+				}
+			}
+			// The address counter advances with each write
+			ddram_address = address + length;
+			// Clear columns 0 to end, a shift by the full 16 bits would be undefined for end == 15
+			dirty[line] &= (uint16_t)~(UINT16_MAX >> (LCD_COLUMNS - 1 - end));
+			column = end + 1;
+		}
+	}
+	if (cursor_address != LCD_ADDRESS_UNKNOWN && ddram_address != cursor_address) {
+		LCD_Write write = {
+			.header = {LCD_CMD_CTRL, 0b10000000 | cursor_address},
+			.header_length = 2,
+		};
+		enqueue(&write);
+		ddram_address = cursor_address;
+	}
+}
+
+uint8_t LCD_add_sink(LCD_Sink sink) {
+	for (uint8_t i = 0; i < LCD_SINKS; i++) {
+		if (!sinks[i]) {
+			sinks[i] = sink;
+			return 1;
+		}
+	}
+	return 0;
 }
 
+void LCD_remove_sink(LCD_Sink sink) {
+	for (uint8_t i = 0; i < LCD_SINKS; i++) {
+		if (sinks[i] == sink) {
+			sinks[i] = NULL;
+		}
+	}
+}
 
-// Set cursor position
-void LCD_set_cursor(uint8_t row, uint8_t col) {
-	LCD_command(0b10000000 | (row + 0x40*col));
+const char* LCD_frame_line(uint8_t line) {
+	return frame[line];
+}
+
+uint8_t LCD_glyph(const uint8_t* bitmap) {
+	uint8_t slot = LCD_GLYPH_SLOTS;
+	for (uint8_t i = 0; i < LCD_GLYPH_SLOTS; i++) {
+		if (glyphs[i] == bitmap) {
+			return LCD_GLYPH_FIRST_CODE + i;
+		}
+		if (!glyphs[i] && slot == LCD_GLYPH_SLOTS) {
+			slot = i;
+		}
+	}
+	if (slot == LCD_GLYPH_SLOTS) {
+		// Every slot is taken, slots are filled in order so the next one holds the oldest glyph
+		slot = oldest_glyph;
+		oldest_glyph = (oldest_glyph + 1) % LCD_GLYPH_SLOTS;
+	}
+	
+	// Set CGRAM address and the 8 rows, in one transaction
+	glyphs[slot] = bitmap;
+	LCD_command_data_run(0b01000000 | (slot << 3), bitmap, 8);
+	return LCD_GLYPH_FIRST_CODE + slot;
 }
 
 void LCD_display_on_off(uint8_t display, uint8_t cursor, uint8_t blinking_cursor) {
@@ -129,3 +463,121 @@ void LCD_display_on_off(uint8_t display, uint8_t cursor, uint8_t blinking_cursor
 	LCD_command(cmd);
 }
 
+// Add a write to the LCD queue and send it if the controller is ready.
+// If the queue is full, waits until the timer has sent the write at its head.
+static void enqueue(const LCD_Write* write) {
+	while (!try_enqueue(write)) { TWI_WAIT_HOOK(); }
+	dispatch();
+}
+
+// Add a write to the LCD queue, returns 0 if the queue is full. Safe to call from an interrupt.
+static uint8_t try_enqueue(const LCD_Write* write) {
+	uint8_t queued = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (command_count < LCD_COMMAND_QUEUE_LENGTH) {
+			commands[(command_head + command_count) % LCD_COMMAND_QUEUE_LENGTH] = *write;
+			command_count++;
+			queued = 1;
+		}
+	}
+	return queued;
+}
+
+// Hand queued writes to the TWI engine until one of them needs the controller to settle.
+// Called from the main loop and from the timer interrupt.
+static void dispatch() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		while (command_count > 0 && !settling && settle_ticks == 0) {
+			const LCD_Write* write = &commands[command_head];
+			TWI_Transaction t = {
+				.address = LCD_ADDRESS,
+				.header_length = write->header_length,
+				.write_data = write->data,
+				.write_length = write->length,
+			};
+			memcpy(t.header, write->header, write->header_length);
+			if (write->settle_ticks) {
+				// The settle time starts when the instruction has gone over the bus
+				t.callback = start_settling;
+				t.context = (void*)(uintptr_t)write->settle_ticks;
+			}
+			if (!TWI_TrySubmit(LCD_TWI_BUS, &t)) {
+				// Bus queue full, try again on the next tick
+				break;
+			}
+			settling = write->settle_ticks != 0;
+			command_head = (command_head + 1) % LCD_COMMAND_QUEUE_LENGTH;
+			command_count--;
+		}
+	}
+}
+
+// TWI completion callback of a slow instruction
+static void start_settling(TWI_Transaction* t) {
+	settle_ticks = (uintptr_t)t->context;
+	settling = 0;
+}
+
+// Returns 1 if nothing is waiting for the controller
+static uint8_t ready() {
+	return command_count == 0 && !settling && settle_ticks == 0;
+}
+
+static uint8_t command_settle_ticks(uint8_t cmd) {
+	// Clear display (0x01) and return home (0x02/0x03)
+	return (cmd == 0x01 || (cmd & 0xFE) == 0x02) ? LCD_SLOW_COMMAND_TICKS : 0;
+}
+
+// Header of a data run, optionally preceded by a command in the same transaction:
+// [command control byte with Co, command,] data control byte, then the data
+static void run_header(LCD_Write* write, uint8_t with_command, uint8_t cmd) {
+	write->header_length = 0;
+	if (with_command) {
+		write->header[write->header_length++] = LCD_CMD_CTRL | LCD_CONTINUE;
+		write->header[write->header_length++] = cmd;
+	}
+	write->header[write->header_length++] = LCD_DATA_CTRL;
+}
+
+// Write a character to the framebuffer at the cursor and advance the cursor.
+// Characters past the end of the line are dropped.
+static void put_char(char c) {
+	if (marquee_active && frame_line == marquee_line) {
+		LCD_marquee_stop();
+	}
+	if (frame_line < LCD_LINES && frame_column < LCD_COLUMNS) {
+		frame[frame_line][frame_column] = c;
+		if (c != ddram[frame_line][frame_column]) {
+			dirty[frame_line] |= DIRTY_BIT(frame_column);
+		}
+		else {
+			dirty[frame_line] &= (uint16_t)~DIRTY_BIT(frame_column);
+		}
+	}
+	frame_column++;
+}
+
+// Fill a line with a string, padded with spaces after it or, if centered, on both sides.
+// `str` is in flash if `in_flash`.
+static void print_line(const char* str, uint8_t in_flash, uint8_t line, uint8_t centered) {
+	size_t len = in_flash ? strlen_P(str) : strlen(str);
+	size_t leftpad = 0;
+	if (centered && len < LCD_COLUMNS) {
+		leftpad = (LCD_COLUMNS - len) / 2;
+	}
+	LCD_set_cursor(0, line);
+	for (size_t i = 0; i < leftpad; i++) {
+		put_char(' ');
+	}
+	for (size_t i = 0; i < len; i++) {
+		put_char(in_flash ? pgm_read_byte(str + i) : str[i]);
+	}
+	for (size_t i = leftpad + len; i < LCD_COLUMNS; i++) {
+		put_char(' ');
+	}
+}
+
+// DDRAM address of a cell, the second line starts at 0x40
+static uint8_t cell_address(uint8_t column, uint8_t line) {
+	return column + 0x40 * line;
+}
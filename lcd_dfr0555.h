@@ -7,34 +7,101 @@
 
 #include <stdint.h>
 
+#define LCD_LINES   2
+#define LCD_COLUMNS 16
+
+// CGRAM holds 8 custom characters (glyphs) of 5x8 dots. Their codes 0-7 repeat at 8-15,
+// and 8-15 are used so that a glyph never ends a string.
+#define LCD_GLYPH_SLOTS      8
+#define LCD_GLYPH_FIRST_CODE 0x08
+
+// The print and clear functions write to a RAM copy of the display (the framebuffer).
+// LCD_flush sends the cells that changed since the last flush.
+// Commands go through a queue and are sent by LCD_tick once the controller is ready for them,
+// so none of these functions wait for the LCD.
+
 // Send command to LCD
 void LCD_command(uint8_t cmd);
 
-// Send one character to LCD
+// Send one character to LCD at its current address, bypassing the framebuffer
 void LCD_data(uint8_t data);
 
-// Write to backlight
+// Send `length` characters (or CGRAM rows) to LCD at its current address in one transaction,
+// bypassing the framebuffer. `data` is sent in place and must stay valid until the bus is idle.
+void LCD_data_run(const uint8_t* data, uint8_t length);
+
+// Same as LCD_data_run, preceded by a command (e.g. set DDRAM or CGRAM address) in the same transaction
+void LCD_command_data_run(uint8_t cmd, const uint8_t* data, uint8_t length);
+
+// Write to a backlight register. Brightness is normally left to the backlight engine (backlight.h).
 void LCD_backlight_write(uint8_t cmd, uint8_t data);
 
-// Initialize LCD (2-line, 5x8 dots, display on, clear)
+// Initialize LCD (2-line, 5x8 dots, display on, clear). Finishes in the background.
 void LCD_init();
 
+// Send queued commands once the controller is ready for them. Call from the 1 ms timer interrupt.
+void LCD_tick();
+
+// The _P variants take a string in flash (PROGMEM, PSTR)
+
 // Print a string to LCD
 void LCD_print(const char* str);
+void LCD_print_P(const char* str);
 
 // Print a string to LCD on a given line
 void LCD_printline(const char* str, uint8_t line);
+void LCD_printline_P(const char* str, uint8_t line);
 
 // Print a string to LCD centered on a given line
 void LCD_printline_centered(const char* str, uint8_t line);
+void LCD_printline_centered_P(const char* str, uint8_t line);
+
+// Show a string of up to 40 characters on a line, scrolling it with the display shift
+// command if it does not fit. Both lines scroll, see lcd_dfr0555.c.
+void LCD_printline_marquee(const char* str, uint8_t line);
+void LCD_printline_marquee_P(const char* str, uint8_t line);
+
+// Stop the marquee and bring the display window back
+void LCD_marquee_stop();
 
 // Clear LCD
 void LCD_clear();
 
-// Clear LCD
+// Clear a line of the LCD
 void LCD_clearline(uint8_t line);
 
-// Set cursor position
-void LCD_set_cursor(uint8_t row, uint8_t col);
+// Set the position the next print writes to
+void LCD_set_cursor(uint8_t column, uint8_t line);
+
+// Send the changed cells of the framebuffer to the LCD
+void LCD_flush();
+
+// A sink gets every run of cells LCD_flush sends to the LCD: `length` characters of the
+// framebuffer starting at `column` of `line`. It is called from LCD_flush, after the run is
+// queued for the LCD, and can show the same frame elsewhere without rendering it again.
+typedef void (*LCD_Sink)(uint8_t column, uint8_t line, const char* cells, uint8_t length);
+
+#define LCD_SINKS 2
+
+// Add a sink, returns 0 if all LCD_SINKS slots are taken
+uint8_t LCD_add_sink(LCD_Sink sink);
+
+// Remove a sink added with LCD_add_sink
+void LCD_remove_sink(LCD_Sink sink);
+
+// The framebuffer's LCD_COLUMNS characters of a line, not NUL terminated
+const char* LCD_frame_line(uint8_t line);
+
+// Show the blinking cursor on a cell, from the next flush on. Moving it costs one command.
+void LCD_cursor(uint8_t column, uint8_t line);
+
+// Hide the cursor
+void LCD_cursor_off();
+
+// Returns the character code that shows `bitmap` (8 rows of 5 dots, bit 4 is the leftmost dot),
+// uploading it to CGRAM the first time it is used. `bitmap` must be static, the cache
+// recognizes glyphs by their address. If all slots hold other glyphs, the oldest upload
+// is replaced, and cells still showing it change with it.
+uint8_t LCD_glyph(const uint8_t* bitmap);
 
 void LCD_display_on_off(uint8_t display, uint8_t cursor, uint8_t blinking_cursor);
\ No newline at end of file
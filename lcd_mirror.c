@@ -0,0 +1,122 @@
+/*
+ * lcd_mirror.c
+ *
+ * Created: 10/17/2026 6:12:40 PM
+ *  Author: agpri
+ */
+
+#include "lcd_mirror.h"
+#include "lcd_dfr0555.h"
+#include <stdio.h>
+
+// Terminal row and column (from 1) of the first cell, inside the border
+#define MIRROR_FIRST_ROW    2
+#define MIRROR_FIRST_COLUMN 2
+
+// First row of the scrolling region below the frame
+#define MIRROR_SCROLL_TOP (MIRROR_FIRST_ROW + LCD_LINES + 1)
+
+#define ESC "\x1b"
+
+static uint8_t enabled = 0;
+
+static void put_number(uint8_t n);
+static void move_to(uint8_t row, uint8_t column);
+static void put_cell(char c);
+static void put_border();
+static void draw_run(uint8_t column, uint8_t line, const char* cells, uint8_t length);
+
+void LCD_Mirror_Enable() {
+	if (enabled) {
+		return;
+	}
+
+	// Clear, then the border and the frame as it is now
+	fputs(ESC "[2J", stdout);
+	move_to(1, 1);
+	put_border();
+	for (uint8_t line = 0; line < LCD_LINES; line++) {
+		const char* cells = LCD_frame_line(line);
+		move_to(MIRROR_FIRST_ROW + line, 1);
+		putchar('|');
+		for (uint8_t column = 0; column < LCD_COLUMNS; column++) {
+			put_cell(cells[column]);
+		}
+		putchar('|');
+	}
+	move_to(MIRROR_FIRST_ROW + LCD_LINES, 1);
+	put_border();
+
+	// Other output scrolls below the frame (this also moves the cursor home)
+	fputs(ESC "[", stdout);
+	put_number(MIRROR_SCROLL_TOP);
+	putchar('r');
+	move_to(MIRROR_SCROLL_TOP, 1);
+
+	if (LCD_add_sink(draw_run)) {
+		enabled = 1;
+	}
+}
+
+void LCD_Mirror_Disable() {
+	if (!enabled) {
+		return;
+	}
+	LCD_remove_sink(draw_run);
+	// Whole screen scrolls again
+	fputs(ESC "[r", stdout);
+	enabled = 0;
+}
+
+uint8_t LCD_Mirror_IsEnabled() {
+	return enabled;
+}
+
+// LCD sink: write the run over the same cells of the terminal, leaving its cursor
+// where the other output left it
+void draw_run(uint8_t column, uint8_t line, const char* cells, uint8_t length) {
+	fputs(ESC "7", stdout);
+	move_to(MIRROR_FIRST_ROW + line, MIRROR_FIRST_COLUMN + column);
+	while (length--) {
+		put_cell(*cells++);
+	}
+	fputs(ESC "8", stdout);
+}
+
+void put_number(uint8_t n) {
+	if (n >= 10) {
+		putchar('0' + n / 10);
+	}
+	putchar('0' + n % 10);
+}
+
+void move_to(uint8_t row, uint8_t column) {
+	fputs(ESC "[", stdout);
+	put_number(row);
+	putchar(';');
+	put_number(column);
+	putchar('H');
+}
+
+// CGRAM glyphs and the full block are shown as '#', the middle dot (0xA5) as '.'
+void put_cell(char c) {
+	uint8_t code = c;
+	if (code < 0x10 || code == 0xFF) {
+		code = '#';
+	}
+	else if (code == 0xA5) {
+		code = '.';
+	}
+	else if (code < 0x20 || code >= 0x7F) {
+		code = '?';
+	}
+	putchar(code);
+}
+
+void put_border() {
+	putchar('+');
+	for (uint8_t column = 0; column < LCD_COLUMNS; column++) {
+		putchar('-');
+	}
+	putchar('+');
+}
@@ -8,14 +8,17 @@
 #define F_CPU 16000000UL
 
 #include <avr/io.h>
-#include <util/delay.h>
 #include <avr/interrupt.h>
 
 #include "uart.h"
 #include "i2c_lib_S25.h"
+#include "twi_profiler.h"
+#include "bcd.h"
 
 #include "ds3231.h"
 #include "lcd_dfr0555.h"
+#include "backlight.h"
+#include "lcd_mirror.h"
 #include "datetime.h"
 #include "button.h"
 #include "potentiometer.h"
@@ -66,6 +69,9 @@ ISR(TCA0_OVF_vect)
 	button_poll_timer_counter++;
 	pot_poll_timer_counter++;
 	buzzer_timer_counter++;
+	TWI_Tick();
+	LCD_tick();
+	Backlight_Tick();
 	TCA0.SINGLE.INTFLAGS |= TCA_SINGLE_OVF_bm; // must clear the interrupt
 }
 
@@ -93,9 +99,16 @@ int main(void)
 	// Initialize UART (debugging)
 	uart_init(3, 9600, NULL);
 	
+#ifdef BCD_BENCHMARK
+	// Cycles per byte of each BCD kernel, to pick BCD_KERNEL for this build
+	BCD_Benchmark();
+#endif
+	
+	// Turn on interrupts, the TWI engine is interrupt driven
+	sei();
+	
 	// Initialize i2c devices (DS3231 RTC and LCD)
 	ds3231_init(NULL, CLOCK_RUN, NO_FORCE_RESET);
-	_delay_ms(1000);
 	LCD_init();
 
 	// Initialize buzzer
@@ -126,9 +139,6 @@ int main(void)
 		POTENTIOMETER_MIN_READING, POTENTIOMETER_MAX_READING,
 		buf, POTENTIOMETER_AVERAGE_N_SAMPLES);
 
-	// Turn on interrupts
-	sei();
-
 	AlarmClock alarmclock = AlarmClock_Init();
 	
     while (1) 
@@ -155,6 +165,33 @@ int main(void)
 			AlarmClock_HandlePotInput(&alarmclock, pot_value);	
 		}
 		
+		// Draw what the handlers above changed, once, and send the changed cells
+		AlarmClock_Render(&alarmclock);
+		LCD_flush();
+		
+		// Commands over the UART: 'm' turns the LCD mirror on or off,
+		// with TWI_PROFILE 'p' prints the I2C counters and 'r' resets them
+		if (USART3.STATUS & USART_RXCIF_bm) {
+			char command = USART3.RXDATAL;
+			if (command == 'm') {
+				if (LCD_Mirror_IsEnabled()) {
+					LCD_Mirror_Disable();
+				}
+				else {
+					LCD_Mirror_Enable();
+				}
+			}
+#ifdef TWI_PROFILE
+			else if (command == 'p') {
+				TWI_Profiler_Dump();
+			}
+			else if (command == 'r') {
+				TWI_Profiler_Reset();
+				TWI_ResetErrorCounters();
+			}
+#endif
+		}
+		
 		if (AlarmClock_GetBuzzerState(&alarmclock) == ALARM_CLOCK_BUZZER_BEEPING) {	
 			if (buzzer_on && buzzer_timer_counter >= BUZZER_ALARM_ON_PERIOD) {
 				buzzer_on = 0;
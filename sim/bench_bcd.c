@@ -0,0 +1,103 @@
+/*
+ * Host benchmark of the BCD kernels in bcd.c (make bench).
+ *
+ * Checks every kernel against a reference over its whole input range,
+ * then times each one in nanoseconds per byte. Host timings only rank
+ * the kernels; AVR cycle counts come from BCD_Benchmark() on the target
+ * (build with BCD_BENCHMARK) and AVR flash sizes from avr-nm -S bcd.o.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bcd.h"
+
+#define ROUNDS 200000
+#define RUNS 5	/* best of, to filter out scheduling noise */
+
+typedef uint8_t (*Kernel)(uint8_t);
+
+typedef struct {
+	const char *name;
+	Kernel kernel;
+	int decode;	/* input is packed BCD */
+} Variant;
+
+static const Variant variants[] = {
+	{"encode subtract", BCD_Encode_Subtract, 0},
+	{"encode table", BCD_Encode_Table, 0},
+	{"encode mulshift", BCD_Encode_MulShift, 0},
+	{"decode shiftadd", BCD_Decode_ShiftAdd, 1},
+	{"decode mulshift", BCD_Decode_MulShift, 1},
+};
+
+#define VARIANT_COUNT (sizeof(variants) / sizeof(variants[0]))
+
+static uint8_t binary[100];
+static uint8_t packed[100];
+volatile uint8_t sink;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* nanoseconds per byte, including the indirect call */
+static double time_kernel(Kernel kernel, const uint8_t *inputs)
+{
+	double best = 0;
+	for (int run = 0; run < RUNS; run++) {
+		double start = now_ns();
+		for (int round = 0; round < ROUNDS; round++) {
+			for (int i = 0; i < 100; i++) {
+				sink = kernel(inputs[i]);
+			}
+		}
+		double elapsed = (now_ns() - start) / (ROUNDS * 100.0);
+		if (run == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+static uint8_t empty_kernel(uint8_t value)
+{
+	return value;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	for (int value = 0; value < 100; value++) {
+		binary[value] = value;
+		packed[value] = (value / 10) << 4 | (value % 10);
+	}
+
+	for (unsigned v = 0; v < VARIANT_COUNT; v++) {
+		for (int value = 0; value < 100; value++) {
+			uint8_t input = variants[v].decode ? packed[value] : binary[value];
+			uint8_t expected = variants[v].decode ? binary[value] : packed[value];
+			uint8_t actual = variants[v].kernel(input);
+			if (actual != expected) {
+				printf("FAIL %s(0x%02X) = 0x%02X, expected 0x%02X\n", variants[v].name, input, actual, expected);
+				failures++;
+			}
+		}
+	}
+	if (failures) {
+		return 1;
+	}
+
+	printf("%-16s %10s\n", "BCD kernel", "ns/byte");
+	printf("%-16s %10.2f\n", "(empty call)", time_kernel(empty_kernel, binary));
+	for (unsigned v = 0; v < VARIANT_COUNT; v++) {
+		const uint8_t *inputs = variants[v].decode ? packed : binary;
+		printf("%-16s %10.2f\n", variants[v].name, time_kernel(variants[v].kernel, inputs));
+	}
+	printf("encode table: %d bytes of flash\n", BCD_TABLE_SIZE);
+	return 0;
+}
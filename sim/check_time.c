@@ -0,0 +1,282 @@
+/*
+ * Host checks of the date and time code (make check).
+ *
+ * Compares the target's loop-free date arithmetic in datetime.c with the C
+ * library's gmtime over every day of 2000-2099, the DS3231's range, and the
+ * display strings of format.c with snprintf, and the zones of timezone.c with
+ * the C library's localtime under the same rules as a POSIX TZ string. Prints
+ * each mismatch and exits with 1 if there was any.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "datetime.h"
+#include "format.h"
+#include "timezone.h"
+
+#define UNIX_2000 946684800LL	/* 2000-01-01 00:00:00 UTC as a Unix time */
+#define DAYS_2000_TO_2099 36525
+#define MAX_FAILURES 20	/* printed, the rest are only counted */
+
+static int failures;
+
+static void fail(const char *what, DateTime_Epoch t, const char *detail)
+{
+	if (failures++ < MAX_FAILURES) {
+		printf("FAIL %s at %lu: %s\n", what, (unsigned long)t, detail);
+	}
+}
+
+/* 1 if dt has the fields gmtime gives for t */
+static int matches_gmtime(const DateTime *dt, int64_t t)
+{
+	time_t unix_time = (time_t)(t + UNIX_2000);
+	struct tm tm;
+	gmtime_r(&unix_time, &tm);
+	return dt->dateValid &&
+		dt->second == tm.tm_sec &&
+		dt->minute == tm.tm_min &&
+		dt->hour == tm.tm_hour &&
+		dt->day == tm.tm_mday &&
+		dt->month == tm.tm_mon + 1 &&
+		dt->year == tm.tm_year - 100 &&
+		dt->dayOfWeek == (DateTime_DayOfWeek)(tm.tm_wday + DateTime_Sunday);
+}
+
+/* Deterministic pseudo-random numbers, so a failure repeats */
+static uint32_t next_random(void)
+{
+	static uint32_t state = 2463534242u;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/* DateTime_ToEpoch and DateTime_FromEpoch, at a few times of every day */
+static void check_epoch(void)
+{
+	static const uint32_t times[] = {0, 1, 43199, 43200, 86399};
+	for (uint32_t day = 0; day < DAYS_2000_TO_2099; day++) {
+		for (unsigned i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+			DateTime_Epoch t = day * DATETIME_SECONDS_PER_DAY + times[i];
+			DateTime dt = DateTime_FromEpoch(t);
+			if (!matches_gmtime(&dt, t)) {
+				fail("DateTime_FromEpoch", t, "differs from gmtime");
+			}
+			if (DateTime_ToEpoch(&dt) != t) {
+				fail("DateTime_ToEpoch", t, "does not invert DateTime_FromEpoch");
+			}
+		}
+	}
+}
+
+/* DateTime_ComputeDayOfWeek of every date, with the stored day of week cleared */
+static void check_day_of_week(void)
+{
+	for (uint32_t day = 0; day < DAYS_2000_TO_2099; day++) {
+		DateTime_Epoch t = day * DATETIME_SECONDS_PER_DAY;
+		time_t unix_time = (time_t)(t + UNIX_2000);
+		struct tm tm;
+		gmtime_r(&unix_time, &tm);
+		DateTime dt = DateTime_FromEpoch(t);
+		dt.dayOfWeek = DateTime_Invalid_Day;
+		if (DateTime_ComputeDayOfWeek(&dt) != (DateTime_DayOfWeek)(tm.tm_wday + DateTime_Sunday)) {
+			fail("DateTime_ComputeDayOfWeek", t, "differs from gmtime");
+		}
+	}
+}
+
+/* DateTime_AddDuration, DateTime_AddTimeDuration and DateTime_Difference from every day */
+static void check_durations(void)
+{
+	const int64_t end = DAYS_2000_TO_2099 * (int64_t)DATETIME_SECONDS_PER_DAY;
+	for (uint32_t day = 0; day < DAYS_2000_TO_2099; day++) {
+		DateTime_Epoch t = day * DATETIME_SECONDS_PER_DAY + next_random() % DATETIME_SECONDS_PER_DAY;
+		DateTime dt = DateTime_FromEpoch(t);
+
+		int16_t days = (int16_t)(next_random() % 1461) - 730;
+		int16_t hours = (int16_t)(next_random() % 97) - 48;
+		int16_t minutes = (int16_t)(next_random() % 241) - 120;
+		int32_t seconds = (int32_t)(next_random() % 200001) - 100000;
+		int64_t expected = t + seconds + minutes * 60LL + hours * 3600LL + days * (int64_t)DATETIME_SECONDS_PER_DAY;
+		if (expected >= 0 && expected < end) {
+			DateTime sum = DateTime_AddDuration(&dt, days, hours, minutes, seconds);
+			if (!matches_gmtime(&sum, expected)) {
+				fail("DateTime_AddDuration", t, "differs from gmtime");
+			}
+			if (DateTime_Difference(&sum, &dt) != expected - t) {
+				fail("DateTime_Difference", t, "is not the duration added");
+			}
+		}
+
+		unsigned h = next_random() % 100, m = next_random() % 1000, s = next_random() % 10000;
+		expected = t + h * 3600LL + m * 60LL + s;
+		if (expected < end) {
+			DateTime sum = DateTime_AddTimeDuration(&dt, h, m, s);
+			if (!matches_gmtime(&sum, expected)) {
+				fail("DateTime_AddTimeDuration", t, "differs from gmtime");
+			}
+		}
+
+		/* Without a date the time wraps around midnight, either way */
+		DateTime time_only = dt;
+		time_only.dateValid = 0;
+		DateTime wrapped = DateTime_AddDuration(&time_only, 0, hours, minutes, seconds);
+		int64_t second_of_day = ((int64_t)DateTime_SecondOfDay(&dt) + seconds + minutes * 60LL + hours * 3600LL) % (int64_t)DATETIME_SECONDS_PER_DAY;
+		if (second_of_day < 0) {
+			second_of_day += DATETIME_SECONDS_PER_DAY;
+		}
+		if (wrapped.dateValid || DateTime_SecondOfDay(&wrapped) != second_of_day) {
+			fail("DateTime_AddDuration without a date", t, "does not wrap around midnight");
+		}
+	}
+}
+
+/* Format_* and the DateTime formatters against snprintf, over all their inputs */
+static void check_format(void)
+{
+	char actual[16], expected[16];
+	for (uint8_t value = 0; value < 100; value++) {
+		*Format_TwoDigits(actual, value) = '\0';
+		snprintf(expected, sizeof(expected), "%02u", value);
+		if (strcmp(actual, expected)) {
+			fail("Format_TwoDigits", value, actual);
+		}
+		*Format_Number(actual, value) = '\0';
+		snprintf(expected, sizeof(expected), "%u", value);
+		if (strcmp(actual, expected)) {
+			fail("Format_Number", value, actual);
+		}
+	}
+
+	for (DateTime_Epoch t = 0; t < DATETIME_SECONDS_PER_DAY; t++) {
+		DateTime dt = DateTime_FromEpoch(t);
+		unsigned hour12 = dt.hour % 12 ? dt.hour % 12 : 12;
+		const char *ampm = dt.hour < 12 ? "AM" : "PM";
+		for (uint8_t twelve_hour = 0; twelve_hour < 2; twelve_hour++) {
+			for (uint8_t seconds = 0; seconds < 2; seconds++) {
+				if (twelve_hour && seconds) {
+					snprintf(expected, sizeof(expected), "%u:%02u:%02u %s", hour12, dt.minute, dt.second, ampm);
+				} else if (twelve_hour) {
+					snprintf(expected, sizeof(expected), "%u:%02u %s", hour12, dt.minute, ampm);
+				} else if (seconds) {
+					snprintf(expected, sizeof(expected), "%02u:%02u:%02u", dt.hour, dt.minute, dt.second);
+				} else {
+					snprintf(expected, sizeof(expected), "%02u:%02u", dt.hour, dt.minute);
+				}
+				if (!DateTime_FormatTime(&dt, actual, sizeof(actual), twelve_hour, seconds) || strcmp(actual, expected)) {
+					fail("DateTime_FormatTime", t, actual);
+				}
+			}
+		}
+	}
+
+	for (uint32_t day = 0; day < DAYS_2000_TO_2099; day++) {
+		DateTime_Epoch t = day * DATETIME_SECONDS_PER_DAY;
+		DateTime dt = DateTime_FromEpoch(t);
+		snprintf(expected, sizeof(expected), "%02u/%02u/%02u", dt.month, dt.day, dt.year);
+		if (!DateTime_FormatDate(&dt, actual, sizeof(actual)) || strcmp(actual, expected)) {
+			fail("DateTime_FormatDate", t, actual);
+		}
+	}
+
+	*Format_String(actual, "Set Time") = '\0';
+	if (strcmp(actual, "Set Time")) {
+		fail("Format_String", 0, actual);
+	}
+}
+
+/* The rules of timezone.c as POSIX TZ strings */
+static const char *const posix_zones[TIMEZONE_COUNT] = {
+	[TIMEZONE_UTC]               = "UTC0",
+	[TIMEZONE_US_EASTERN]        = "EST5EDT,M3.2.0,M11.1.0",
+	[TIMEZONE_US_CENTRAL]        = "CST6CDT,M3.2.0,M11.1.0",
+	[TIMEZONE_US_MOUNTAIN]       = "MST7MDT,M3.2.0,M11.1.0",
+	[TIMEZONE_US_ARIZONA]        = "MST7",
+	[TIMEZONE_US_PACIFIC]        = "PST8PDT,M3.2.0,M11.1.0",
+	[TIMEZONE_UK]                = "GMT0BST,M3.5.0/1,M10.5.0",
+	[TIMEZONE_CENTRAL_EUROPE]    = "CET-1CEST,M3.5.0,M10.5.0/3",
+	[TIMEZONE_AUSTRALIA_EASTERN] = "AEST-10AEDT,M10.1.0,M4.1.0/3",
+};
+
+/* Local time minus UTC at t, from the C library */
+static int32_t posix_offset(DateTime_Epoch t)
+{
+	time_t unix_time = (time_t)(t + UNIX_2000);
+	struct tm tm;
+	localtime_r(&unix_time, &tm);
+	return (int32_t)tm.tm_gmtoff;
+}
+
+/*
+ * Each zone from the second day of 2000 to the last of 2099 (west of UTC the
+ * first hours of 2000 are shown as UTC), at every hour and the second before it,
+ * as the transitions of these zones are on the hour:
+ * - the cached TimeZone_ToLocal, read forward like the clock does, and
+ *   TimeZone_ToLocalAt against localtime;
+ * - TimeZone_ToUTC of the local times, which gives back the instant, or the first
+ *   one when the local time repeats;
+ * - TimeZone_ToUTC of a local time on the half hour, which may have been skipped,
+ *   and TimeZone_NextLocalTime of it.
+ */
+static void check_timezones(void)
+{
+	const DateTime_Epoch start = DATETIME_SECONDS_PER_DAY;
+	const DateTime_Epoch end = (DAYS_2000_TO_2099 - 1) * DATETIME_SECONDS_PER_DAY;
+	for (TimeZone_Id id = 0; id < TIMEZONE_COUNT; id++) {
+		setenv("TZ", posix_zones[id], 1);
+		tzset();
+		TimeZone zone = TimeZone_New(id, start - 1);
+		for (DateTime_Epoch hour = start; hour < end; hour += 3600) {
+			for (DateTime_Epoch t = hour - 1; t <= hour; t++) {
+				DateTime_Epoch local = t + posix_offset(t);
+				if (TimeZone_ToLocal(&zone, t) != local) {
+					fail(posix_zones[id], t, "TimeZone_ToLocal differs from localtime");
+				}
+				if (TimeZone_ToLocalAt(&zone, t) != local) {
+					fail(posix_zones[id], t, "TimeZone_ToLocalAt differs from localtime");
+				}
+				DateTime_Epoch utc = TimeZone_ToUTC(&zone, local);
+				if (utc != t && (utc > t || TimeZone_ToLocalAt(&zone, utc) != local)) {
+					fail(posix_zones[id], t, "TimeZone_ToUTC does not give back the first instant");
+				}
+			}
+
+			/* A skipped local time gives the transition, after which the clock reads later */
+			DateTime_Epoch local = hour + posix_offset(hour) + 1800;
+			DateTime_Epoch utc = TimeZone_ToUTC(&zone, local);
+			DateTime_Epoch read = TimeZone_ToLocalAt(&zone, utc);
+			if (read != local && (read < local || TimeZone_ToLocalAt(&zone, utc - 1) >= local)) {
+				fail(posix_zones[id], hour, "TimeZone_ToUTC of a local time");
+			}
+
+			uint32_t second_of_day = local % DATETIME_SECONDS_PER_DAY;
+			DateTime_Epoch next = TimeZone_NextLocalTime(&zone, hour, second_of_day);
+			read = TimeZone_ToLocalAt(&zone, next);
+			if (next <= hour || next - hour > DATETIME_SECONDS_PER_DAY + 3600 ||
+				(read % DATETIME_SECONDS_PER_DAY != second_of_day && TimeZone_ToLocalAt(&zone, next - 1) >= read - 1)) {
+				fail(posix_zones[id], hour, "TimeZone_NextLocalTime");
+			}
+		}
+	}
+}
+
+int main(void)
+{
+	check_epoch();
+	check_day_of_week();
+	check_durations();
+	check_format();
+	check_timezones();
+
+	if (failures) {
+		printf("%d failures\n", failures);
+		return 1;
+	}
+	printf("datetime, format, timezone: all checks passed\n");
+	return 0;
+}
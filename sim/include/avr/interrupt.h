@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for <avr/interrupt.h>.
+ * ISRs become plain functions that the simulator calls.
+ */
+#ifndef SIM_AVR_INTERRUPT_H
+#define SIM_AVR_INTERRUPT_H
+
+#define ISR(vector) void vector(void)
+#define sei()
+#define cli()
+
+#endif
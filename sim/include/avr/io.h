@@ -0,0 +1,112 @@
+/*
+ * Host stand-in for <avr/io.h>.
+ *
+ * Only the peripherals the portable drivers touch are declared. TWI0 is a
+ * plain struct that the simulator (sim_twi.c) watches: MADDR, MDATA and
+ * MCTRLB are 16 bits wide here so the simulator can park them at
+ * SIM_REG_EMPTY and see every 8-bit write the TWI engine makes. TCB0 and
+ * TCB1 are read through sim_tcb(), which brings CNT up to the simulated time.
+ */
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+#include <avr/sfr_defs.h>
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+#define SIM_REG_EMPTY 0xFFFF
+
+typedef struct {
+	register8_t CTRLA;
+	register8_t DUALCTRL;
+	register8_t DBGCTRL;
+	register8_t MCTRLA;
+	register16_t MCTRLB;
+	register8_t MSTATUS;
+	register8_t MBAUD;
+	register16_t MADDR;
+	register16_t MDATA;
+} TWI_t;
+
+typedef struct {
+	register8_t DIR, DIRSET, DIRCLR, DIRTGL;
+	register8_t OUT, OUTSET, OUTCLR, OUTTGL;
+	register8_t IN;
+	register8_t INTFLAGS;
+	register8_t PIN0CTRL, PIN1CTRL, PIN2CTRL, PIN3CTRL, PIN4CTRL, PIN5CTRL, PIN6CTRL, PIN7CTRL;
+} PORT_t;
+
+typedef struct {
+	register8_t DIR, OUT, IN, INTFLAGS;
+} VPORT_t;
+
+typedef struct {
+	register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLE;
+	register8_t MUXPOS;
+	register8_t COMMAND;
+	register16_t RES;
+} ADC_t;
+
+typedef struct {
+	register8_t CTRLA, CTRLB;
+	register8_t EVCTRL, INTCTRL, INTFLAGS, STATUS, DBGCTRL, TEMP;
+	register16_t CNT;
+	register16_t CCMP;
+} TCB_t;
+
+TCB_t* sim_tcb(uint8_t n);
+#define TCB0 (*sim_tcb(0))
+#define TCB1 (*sim_tcb(1))
+
+extern TWI_t TWI0;
+extern TWI_t TWI1;
+extern PORT_t PORTA;
+extern PORT_t PORTF;
+extern VPORT_t VPORTC;
+
+#define TWI_FMPEN_bm            0x02
+
+#define TWI_ENABLE_bm           0x01
+#define TWI_WIEN_bm             0x40
+#define TWI_RIEN_bm             0x80
+
+#define TWI_MCMD_gm             0x03
+#define TWI_MCMD_NOACT_gc       0x00
+#define TWI_MCMD_REPSTART_gc    0x01
+#define TWI_MCMD_RECVTRANS_gc   0x02
+#define TWI_MCMD_STOP_gc        0x03
+#define TWI_ACKACT_bm           0x04
+#define TWI_FLUSH_bm            0x08
+
+#define TWI_BUSSTATE_gm         0x03
+#define TWI_BUSSTATE_UNKNOWN_gc 0x00
+#define TWI_BUSSTATE_IDLE_gc    0x01
+#define TWI_BUSSTATE_OWNER_gc   0x02
+#define TWI_BUSSTATE_BUSY_gc    0x03
+#define TWI_BUSERR_bm           0x04
+#define TWI_ARBLOST_bm          0x08
+#define TWI_RXACK_bm            0x10
+#define TWI_CLKHOLD_bm          0x20
+#define TWI_WIF_bm              0x40
+#define TWI_WIF_bp              6
+#define TWI_RIF_bm              0x80
+#define TWI_RIF_bp              7
+
+#define TCB_ENABLE_bm           0x01
+#define TCB_CLKSEL_gm           0x0E
+#define TCB_CLKSEL_DIV1_gc      0x00
+#define TCB_CLKSEL_DIV2_gc      0x02
+#define TCB_CNTMODE_INT_gc      0x00
+
+#define PIN0_bm 0x01
+#define PIN1_bm 0x02
+#define PIN2_bm 0x04
+#define PIN3_bm 0x08
+#define PIN4_bm 0x10
+#define PIN5_bm 0x20
+#define PIN6_bm 0x40
+#define PIN7_bm 0x80
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * Host stand-in for <avr/pgmspace.h>.
+ * The host has one address space, so flash data is ordinary const data.
+ */
+#ifndef SIM_AVR_PGMSPACE_H
+#define SIM_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define memcpy_P memcpy
+#define printf_P printf
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for <util/atomic.h>.
+ * The simulator only runs interrupt handlers between statements of the
+ * program (never in the middle of one), so atomic blocks need no locking.
+ */
+#ifndef SIM_UTIL_ATOMIC_H
+#define SIM_UTIL_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int sim_atomic_once = 1; sim_atomic_once; sim_atomic_once = 0)
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for <util/delay.h>.
+ * Busy-wait delays advance simulated time instead of spinning.
+ */
+#ifndef SIM_UTIL_DELAY_H
+#define SIM_UTIL_DELAY_H
+
+void sim_delay_us(double us);
+
+#define _delay_us(us) sim_delay_us(us)
+#define _delay_ms(ms) sim_delay_us((ms) * 1000.0)
+
+#endif
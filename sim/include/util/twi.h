@@ -0,0 +1 @@
+/* Host stand-in for <util/twi.h>, the drivers only use their own TW_READ/TW_WRITE */
@@ -0,0 +1,105 @@
+/*
+ * sim.h
+ *
+ * Created: 10/17/2026 3:05:12 PM
+ *  Author: agpri
+ *
+ * Host simulator for the alarm clock's I2C buses. TWI0 and TWI1 are modelled
+ * at the register level: the real TWI engine (i2c_lib_S25.c) writes MADDR, MDATA
+ * and MCTRLB, the simulator plays each bus against the device models attached
+ * to it and calls the host interrupt handler, and counts SCL cycles per device.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SIM_F_CPU 16000000UL
+
+// Rise time added to every SCL period when converting cycles to time
+#define SIM_RISE_TIME_NS 100
+
+// A client on the simulated bus
+typedef struct {
+	const char* name;
+	uint8_t address;
+	void (*start)(uint8_t read);	// addressed after a START or repeated START
+	void (*write)(uint8_t data);	// byte written by the host
+	uint8_t (*read)(void);		// byte read by the host
+	void (*stop)(void);		// STOP, or the transaction ended with a repeated START to another direction
+} SimDevice;
+
+// Bus traffic counted per device
+typedef struct {
+	uint32_t transactions;	// STARTs, repeated STARTs are not counted
+	uint32_t bytes;		// address and data bytes
+	uint64_t cycles;	// SCL periods including START and STOP
+	double busy_us;		// time those cycles took at the MBAUD in use
+} SimBusStats;
+
+// Simulated time since reset, in microseconds
+extern uint64_t sim_time_us;
+
+// Number of buses: 0 is TWI0, 1 is TWI1
+#define SIM_BUS_COUNT 2
+
+// Attach a device model to a bus
+void sim_bus_attach(uint8_t bus, const SimDevice* device);
+
+// Function called every simulated millisecond, like the TCA0 overflow interrupt on the target
+void sim_set_tick_handler(void (*handler)(void));
+
+// Function called every simulated second (the DS3231 model's 1 Hz oscillator)
+void sim_set_second_handler(void (*handler)(void));
+
+// Start the pending TWI register writes from the engine and complete the next bus
+// operation, calling its interrupt handler. Returns 0 if nothing was pending.
+uint8_t sim_twi_step();
+
+// Move simulated time forward, firing the tick and second handlers that fall due
+void sim_advance(uint64_t us);
+
+// Run the buses and the timers until simulated time reaches `us`
+void sim_run_until(uint64_t us);
+
+// Called by the TWI engine while it waits: runs the buses, or the timers if they are idle
+void sim_wait_hook();
+
+// Traffic of one device, or of all devices if `address` is 0
+SimBusStats sim_bus_stats(uint8_t address);
+
+// Print the traffic between two snapshots of every attached device
+void sim_bus_report(FILE* out, const SimBusStats before[], const SimBusStats after[]);
+
+// Snapshot of every attached device, in attach order. `stats` must hold SIM_MAX_DEVICES entries.
+#define SIM_MAX_DEVICES 4
+void sim_bus_snapshot(SimBusStats stats[]);
+
+// Microseconds the given number of SCL cycles take at a bus's current MBAUD
+double sim_cycles_to_us(uint8_t bus, uint64_t cycles);
+
+// Device models
+extern const SimDevice sim_ds3231;
+extern const SimDevice sim_lcd;
+extern const SimDevice sim_backlight;
+
+// DS3231 model: set the time registers (binary values) and advance them by a second
+void sim_ds3231_set(uint8_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+void sim_ds3231_tick_second();
+uint8_t sim_ds3231_register(uint8_t reg);
+
+// LCD model: print the visible 2x16 window
+void sim_lcd_render(FILE* out);
+
+// LCD model: the visible 16 characters of a row (0 or 1), drawn as sim_lcd_render does
+void sim_lcd_line(uint8_t row, char line[17]);
+
+// LCD model: instructions that arrived while the controller was busy
+uint32_t sim_lcd_busy_violations();
+
+// Backlight model: PWM value of channel 1 (blue) as last latched by an update write
+uint8_t sim_backlight_level();
+
+#endif // SIM_H
@@ -0,0 +1,63 @@
+/*
+ * sim_backlight.c
+ *
+ * Created: 10/17/2026 4:10:52 PM
+ *  Author: agpri
+ *
+ * RGB backlight driver model (PCA9633 style register file at 0x6B). The first byte of
+ * a write sets the register pointer, which auto-increments. PWM registers 0x04 to 0x06
+ * only take effect when register 0x07 is written, writing register 0x2F resets them.
+ */
+
+#include "sim.h"
+#include <string.h>
+
+#define REGISTER_PWM_BLUE 0x04
+#define REGISTER_UPDATE 0x07
+#define REGISTER_RESET 0x2F
+
+static uint8_t registers[0x30];
+static uint8_t pointer = 0;
+static uint8_t pointer_written = 0;
+static uint8_t level = 0;
+
+static void start(uint8_t read) {
+	if (!read) {
+		pointer_written = 0;
+	}
+}
+
+static void write(uint8_t data) {
+	if (!pointer_written) {
+		pointer = data % sizeof(registers);
+		pointer_written = 1;
+		return;
+	}
+
+	if (pointer == REGISTER_RESET) {
+		memset(registers, 0, sizeof(registers));
+		level = 0;
+	}
+	else {
+		registers[pointer] = data;
+		if (pointer == REGISTER_UPDATE) {
+			level = registers[REGISTER_PWM_BLUE];
+		}
+	}
+	pointer = (pointer + 1) % sizeof(registers);
+}
+
+static uint8_t read(void) {
+	uint8_t data = registers[pointer];
+	pointer = (pointer + 1) % sizeof(registers);
+	return data;
+}
+
+static void stop(void) {
+}
+
+const SimDevice sim_backlight = {"backlight", 0x6B, start, write, read, stop};
+
+uint8_t sim_backlight_level() {
+	return level;
+}
@@ -0,0 +1,136 @@
+/*
+ * sim_ds3231.c
+ *
+ * Created: 10/17/2026 3:41:09 PM
+ *  Author: agpri
+ *
+ * DS3231 model: 19 BCD registers behind an auto-incrementing register pointer.
+ * The first byte of a write sets the pointer, reads continue from it.
+ * The time registers count in 24 hour mode with the calendar rollover of the chip.
+ */
+
+#include "sim.h"
+
+#define REGISTER_COUNT 0x13
+#define REGISTER_CONTROL_STATUS 0x0F
+#define STATUS_FLAGS 0x83	// OSF, A2F, A1F: the host can only clear them
+
+static uint8_t registers[REGISTER_COUNT] = {
+	0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00,	// 00:00:00, day 1, 01/01/00
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// alarms
+	0x1C, 0x80, 0x00,				// control, status (OSF set at power on), aging
+	0x19, 0x40,					// 25.25 degrees C
+};
+static uint8_t pointer = 0;
+static uint8_t pointer_written = 0;
+
+static uint8_t to_bcd(uint8_t value) {
+	return ((value / 10) << 4) | (value % 10);
+}
+
+static uint8_t from_bcd(uint8_t value) {
+	return (value >> 4) * 10 + (value & 0x0F);
+}
+
+static uint8_t days_in_month(uint8_t month, uint8_t year) {
+	static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	if (month == 2 && year % 4 == 0) {
+		return 29;
+	}
+	return days[month - 1];
+}
+
+static void start(uint8_t read) {
+	if (!read) {
+		pointer_written = 0;
+	}
+}
+
+static void write(uint8_t data) {
+	if (!pointer_written) {
+		pointer = data % REGISTER_COUNT;
+		pointer_written = 1;
+		return;
+	}
+
+	if (pointer == REGISTER_CONTROL_STATUS) {
+		uint8_t flags = registers[pointer] & data & STATUS_FLAGS;
+		registers[pointer] = (data & ~STATUS_FLAGS) | flags;
+	}
+	else if (pointer < 0x11) {
+		// The temperature registers are read only
+		registers[pointer] = data;
+	}
+	pointer = (pointer + 1) % REGISTER_COUNT;
+}
+
+static uint8_t read(void) {
+	uint8_t data = registers[pointer];
+	pointer = (pointer + 1) % REGISTER_COUNT;
+	return data;
+}
+
+static void stop(void) {
+}
+
+const SimDevice sim_ds3231 = {"ds3231", 0x68, start, write, read, stop};
+
+void sim_ds3231_set(uint8_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+	registers[0] = to_bcd(second);
+	registers[1] = to_bcd(minute);
+	registers[2] = to_bcd(hour);
+	registers[4] = to_bcd(day);
+	registers[5] = to_bcd(month);
+	registers[6] = to_bcd(year);
+	// The clock has been running on its battery
+	registers[REGISTER_CONTROL_STATUS] &= ~0x80;
+}
+
+void sim_ds3231_tick_second() {
+	uint8_t second = from_bcd(registers[0]) + 1;
+	uint8_t minute = from_bcd(registers[1]);
+	uint8_t hour = from_bcd(registers[2] & 0x3F);
+	uint8_t day_of_week = registers[3];
+	uint8_t day = from_bcd(registers[4]);
+	uint8_t month = from_bcd(registers[5] & 0x1F);
+	uint8_t century = registers[5] & 0x80;
+	uint8_t year = from_bcd(registers[6]);
+
+	if (second == 60) {
+		second = 0;
+		minute++;
+	}
+	if (minute == 60) {
+		minute = 0;
+		hour++;
+	}
+	if (hour == 24) {
+		hour = 0;
+		day_of_week = (day_of_week % 7) + 1;
+		day++;
+	}
+	if (day > days_in_month(month, year)) {
+		day = 1;
+		month++;
+	}
+	if (month == 13) {
+		month = 1;
+		year++;
+	}
+	if (year == 100) {
+		year = 0;
+		century ^= 0x80;
+	}
+
+	registers[0] = to_bcd(second);
+	registers[1] = to_bcd(minute);
+	registers[2] = to_bcd(hour);
+	registers[3] = day_of_week;
+	registers[4] = to_bcd(day);
+	registers[5] = to_bcd(month) | century;
+	registers[6] = to_bcd(year);
+}
+
+uint8_t sim_ds3231_register(uint8_t reg) {
+	return registers[reg % REGISTER_COUNT];
+}
@@ -0,0 +1,212 @@
+/*
+ * sim_lcd.c
+ *
+ * Created: 10/17/2026 3:58:30 PM
+ *  Author: agpri
+ *
+ * DFR0555 LCD controller model (HD44780 instruction set behind an I2C control byte).
+ * Every transaction starts with a control byte: Co (bit 7) set means another control
+ * byte follows the next data byte, RS (bit 6) selects data instead of a command.
+ *
+ * Instruction execution times are modelled: an instruction that arrives while the
+ * controller is still powering up or executing the previous one is counted as a
+ * busy violation (on hardware it would be lost or corrupted).
+ */
+
+#include "sim.h"
+#include <string.h>
+
+#define DDRAM_ROW_LENGTH 40
+#define VISIBLE_COLUMNS 16
+
+static uint8_t ddram[2][DDRAM_ROW_LENGTH];
+static uint8_t cgram[64];
+static uint8_t address = 0;		// DDRAM address (row 1 starts at 0x40) or CGRAM address
+static uint8_t in_cgram = 0;
+static uint8_t increment = 1;
+static uint8_t entry_shift = 0;
+static uint8_t window = 0;		// DDRAM column shown in the first visible column
+static uint8_t display_on = 0;
+static uint8_t cursor_on = 0;
+static uint8_t blink_on = 0;
+static uint8_t initialized = 0;
+
+// Execution times, from the HD44780 datasheet
+#define POWER_UP_US 40000
+#define CLEAR_HOME_US 1530
+#define INSTRUCTION_US 39
+#define DATA_US 43
+
+static uint64_t busy_until_us = POWER_UP_US;
+static uint32_t busy_violations = 0;
+
+static uint8_t expect_control = 1;
+static uint8_t continuation = 0;
+static uint8_t register_select = 0;
+
+static void clear() {
+	memset(ddram, ' ', sizeof(ddram));
+	address = 0;
+	in_cgram = 0;
+	increment = 1;
+	window = 0;
+}
+
+// Moves the address counter one position, row 0 runs on into row 1 and back
+static void step_address(uint8_t forward) {
+	if (in_cgram) {
+		address = (address + (forward ? 1 : 63)) & 0x3F;
+		return;
+	}
+	uint8_t row = address >> 6;
+	uint8_t column = address & 0x3F;
+	if (forward) {
+		if (++column == DDRAM_ROW_LENGTH) {
+			column = 0;
+			row ^= 1;
+		}
+	}
+	else {
+		if (column-- == 0) {
+			column = DDRAM_ROW_LENGTH - 1;
+			row ^= 1;
+		}
+	}
+	address = (row << 6) | column;
+}
+
+static void shift_display(uint8_t right) {
+	window = (window + (right ? DDRAM_ROW_LENGTH - 1 : 1)) % DDRAM_ROW_LENGTH;
+}
+
+static void data(uint8_t value) {
+	if (in_cgram) {
+		cgram[address] = value;
+	}
+	else {
+		ddram[address >> 6][(address & 0x3F) % DDRAM_ROW_LENGTH] = value;
+		if (entry_shift) {
+			shift_display(!increment);
+		}
+	}
+	step_address(increment);
+}
+
+static void command(uint8_t value) {
+	if (value & 0x80) {
+		// Set DDRAM address
+		address = value & 0x7F;
+		in_cgram = 0;
+	}
+	else if (value & 0x40) {
+		// Set CGRAM address
+		address = value & 0x3F;
+		in_cgram = 1;
+	}
+	else if (value & 0x20) {
+		// Function set, the model is always 2 lines of 5x8 dots
+	}
+	else if (value & 0x10) {
+		// Cursor or display shift
+		uint8_t right = value & 0x04;
+		if (value & 0x08) {
+			shift_display(right);
+		}
+		else {
+			step_address(right);
+		}
+	}
+	else if (value & 0x08) {
+		display_on = (value & 0x04) != 0;
+		cursor_on = (value & 0x02) != 0;
+		blink_on = (value & 0x01) != 0;
+	}
+	else if (value & 0x04) {
+		increment = (value & 0x02) != 0;
+		entry_shift = value & 0x01;
+	}
+	else if (value & 0x02) {
+		// Return home
+		address = 0;
+		in_cgram = 0;
+		window = 0;
+	}
+	else if (value & 0x01) {
+		clear();
+	}
+}
+
+static void start(uint8_t read) {
+	if (!initialized) {
+		clear();
+		initialized = 1;
+	}
+	expect_control = 1;
+}
+
+static void write(uint8_t value) {
+	if (expect_control) {
+		continuation = value & 0x80;
+		register_select = value & 0x40;
+		expect_control = 0;
+		return;
+	}
+	if (sim_time_us < busy_until_us) {
+		busy_violations++;
+	}
+	if (register_select) {
+		data(value);
+		busy_until_us = sim_time_us + DATA_US;
+	}
+	else {
+		command(value);
+		// Clear display and return home
+		busy_until_us = sim_time_us + ((value == 0x01 || (value & 0xFE) == 0x02) ? CLEAR_HOME_US : INSTRUCTION_US);
+	}
+	if (continuation) {
+		expect_control = 1;
+	}
+}
+
+static uint8_t read(void) {
+	return 0;	// busy flag clear
+}
+
+static void stop(void) {
+}
+
+const SimDevice sim_lcd = {"lcd", 0x3E, start, write, read, stop};
+
+uint32_t sim_lcd_busy_violations() {
+	return busy_violations;
+}
+
+void sim_lcd_line(uint8_t row, char line[VISIBLE_COLUMNS + 1]) {
+	if (!initialized) {
+		clear();
+		initialized = 1;
+	}
+	for (uint8_t column = 0; column < VISIBLE_COLUMNS; column++) {
+		uint8_t c = ddram[row][(window + column) % DDRAM_ROW_LENGTH];
+		// CGRAM characters and the full block are drawn as '#', the middle dot as '.'
+		line[column] = (c < 0x10 || c == 0xFF) ? '#' : (c == 0xA5) ? '.' : (c >= 0x20 && c < 0x7F) ? c : '?';
+	}
+	line[VISIBLE_COLUMNS] = '\0';
+}
+
+void sim_lcd_render(FILE* out) {
+	fprintf(out, "  +----------------+%s\n", display_on ? "" : " (display off)");
+	for (uint8_t row = 0; row < 2; row++) {
+		char line[VISIBLE_COLUMNS + 1];
+		sim_lcd_line(row, line);
+		fprintf(out, "  |%s|\n", line);
+	}
+	fprintf(out, "  +----------------+\n");
+	if (display_on && (cursor_on || blink_on) && !in_cgram) {
+		// The cursor is drawn at the address counter
+		uint8_t column = ((address & 0x3F) + DDRAM_ROW_LENGTH - window) % DDRAM_ROW_LENGTH;
+		if (column < VISIBLE_COLUMNS) {
+			fprintf(out, "  cursor%s at line %u, column %u\n", blink_on ? " (blinking)" : "", address >> 6, column);
+		}
+	}
+}
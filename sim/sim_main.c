@@ -0,0 +1,348 @@
+/*
+ * sim_main.c
+ *
+ * Created: 10/17/2026 4:25:16 PM
+ *  Author: agpri
+ *
+ * Runs the alarm clock on the host against the simulated bus and reports the
+ * I2C traffic of each scenario. The drivers (ds3231.c, lcd_dfr0555.c) and the
+ * application (alarmclock.c) are the target sources, unchanged; this file plays
+ * the part of main.c, with scripted button presses and potentiometer values.
+ * Each scenario checks what it should leave on the display, the backlight and
+ * the DS3231, and the simulator exits with 1 if a check failed.
+ *
+ * Usage: alarmclock_sim [-v | -m]
+ *   -v  also print the application's own output (time reads, errors)
+ *   -m  also mirror the LCD to the terminal (lcd_mirror.h), with the application's output
+ */
+
+#include "sim.h"
+#include "i2c_lib_S25.h"
+#include "ds3231.h"
+#include "lcd_dfr0555.h"
+#include "backlight.h"
+#include "lcd_mirror.h"
+#include "twi_profiler.h"
+#include "alarmclock.h"
+#include <string.h>
+#include <unistd.h>
+
+// Same schedule as main.c
+#define BUTTON_POLL_PERIOD_MS 20
+#define POT_POLL_PERIOD_MS 20
+#define DS3231_POLL_PERIOD_MS 1000
+
+static volatile uint16_t ds3231_poll_timer_counter = 0;
+static volatile uint16_t button_poll_timer_counter = 0;
+static volatile uint16_t pot_poll_timer_counter = 0;
+
+static AlarmClock alarmclock;
+static float pot_value = 0.0;
+static uint8_t pending_press = 0;	// button (1 to 3) to report as just pushed on the next poll
+
+static FILE* report;
+static unsigned failures = 0;
+
+// Report a failed check of the scenario that just ran
+static void expect(uint8_t condition, const char* what) {
+	if (!condition) {
+		fprintf(report, "  FAIL %s\n", what);
+		failures++;
+	}
+}
+
+// 1 if a row of the visible LCD contains `text`
+static uint8_t lcd_shows(uint8_t row, const char* text) {
+	char line[17];
+	sim_lcd_line(row, line);
+	return strstr(line, text) != NULL;
+}
+
+// DS3231 time register as a binary value
+static uint8_t ds3231_value(uint8_t reg) {
+	uint8_t bcd = sim_ds3231_register(reg);
+	return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+// Average SCL period of a device's traffic so far, in microseconds
+static double scl_period_us(uint8_t address) {
+	SimBusStats stats = sim_bus_stats(address);
+	return stats.cycles ? stats.busy_us / stats.cycles : 0;
+}
+
+// Stands in for the TCA0 overflow interrupt
+static void tick() {
+	ds3231_poll_timer_counter++;
+	button_poll_timer_counter++;
+	pot_poll_timer_counter++;
+	TWI_Tick();
+	LCD_tick();
+	Backlight_Tick();
+}
+
+// One pass of main.c's loop
+static void loop_once() {
+	if (ds3231_poll_timer_counter >= DS3231_POLL_PERIOD_MS) {
+		ds3231_poll_timer_counter = 0;
+		AlarmClock_FetchTime(&alarmclock);
+	}
+
+	if (button_poll_timer_counter >= BUTTON_POLL_PERIOD_MS) {
+		button_poll_timer_counter = 0;
+		ButtonState released = {BUTTON_RELEASED, BUTTON_NO_TRANSITION};
+		ButtonState pushed = {BUTTON_PUSHED, BUTTON_JUST_PUSHED};
+		AlarmClock_HandleButtonInput(&alarmclock,
+			(pending_press == 1) ? pushed : released,
+			(pending_press == 2) ? pushed : released,
+			(pending_press == 3) ? pushed : released);
+		pending_press = 0;
+	}
+
+	if (pot_poll_timer_counter >= POT_POLL_PERIOD_MS) {
+		pot_poll_timer_counter = 0;
+		AlarmClock_HandlePotInput(&alarmclock, pot_value);
+	}
+
+	AlarmClock_Render(&alarmclock);
+	LCD_flush();
+
+	sim_run_until(sim_time_us + 1000);
+}
+
+static void run_for_ms(uint32_t ms) {
+	uint64_t end = sim_time_us + ms * 1000ULL;
+	while (sim_time_us < end) {
+		loop_once();
+	}
+}
+
+// Push a button for one poll, then give the display time to update
+static void press(uint8_t button) {
+	pending_press = button;
+	run_for_ms(2 * BUTTON_POLL_PERIOD_MS);
+}
+
+static SimBusStats before[SIM_MAX_DEVICES];
+static uint64_t scenario_start_us;
+
+static void begin_scenario() {
+	sim_bus_snapshot(before);
+	scenario_start_us = sim_time_us;
+}
+
+static void end_scenario(const char* name) {
+	SimBusStats after[SIM_MAX_DEVICES];
+	sim_bus_snapshot(after);
+	fprintf(report, "%s (%.2f s simulated)\n", name, (sim_time_us - scenario_start_us) / 1e6);
+	sim_bus_report(report, before, after);
+	fprintf(report, "\n");
+}
+
+int main(int argc, char** argv) {
+	uint8_t mirror = (argc > 1 && strcmp(argv[1], "-m") == 0);
+	uint8_t verbose = mirror || (argc > 1 && strcmp(argv[1], "-v") == 0);
+	report = fdopen(dup(fileno(stdout)), "w");
+	setvbuf(report, NULL, _IOLBF, 0);
+	if (!verbose) {
+		freopen("/dev/null", "w", stdout);
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	// Wired as i2c_lib_S25.h describes
+	sim_bus_attach(0, &sim_ds3231);
+#ifdef TWI_SEPARATE_BUSES
+	sim_bus_attach(1, &sim_lcd);
+	sim_bus_attach(1, &sim_backlight);
+#else
+	sim_bus_attach(0, &sim_lcd);
+	sim_bus_attach(0, &sim_backlight);
+#endif
+	sim_set_tick_handler(tick);
+	sim_set_second_handler(sim_ds3231_tick_second);
+	// The DS3231 keeps UTC, the clock shows US Eastern time (4 hours behind in summer)
+	sim_ds3231_set(25, 5, 4, 15, 59, 30);
+
+	begin_scenario();
+	ds3231_init(NULL, CLOCK_RUN, NO_FORCE_RESET);
+	LCD_init();
+	alarmclock = AlarmClock_Init();
+	if (mirror) {
+		LCD_Mirror_Enable();
+	}
+	// The LCD initializes in the background, the main loop keeps running meanwhile
+	run_for_ms(100);
+	end_scenario("boot");
+	// Each device's transactions run at its own speed (TWI_AddDevice)
+	fprintf(report, "  DS3231 %.2f us, LCD %.2f us per SCL cycle\n",
+		scl_period_us(sim_ds3231.address), scl_period_us(sim_lcd.address));
+	expect(scl_period_us(sim_ds3231.address) <= 2.5, "the DS3231 runs in fast mode (400 kHz)");
+	expect(scl_period_us(sim_lcd.address) * 9 >= 43, "LCD data bytes are at least 43 us apart");
+	fprintf(report, "\n");
+
+	begin_scenario();
+	run_for_ms(60000);
+	end_scenario("clock display, 60 s");
+
+	// Button 3 switches to the big digit face, the glyphs are uploaded once on the first draw
+	begin_scenario();
+	press(3);
+	end_scenario("switch to big digits");
+	fprintf(report, "LCD:\n");
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+
+	begin_scenario();
+	run_for_ms(60000);
+	end_scenario("big digit clock display, 60 s");
+	press(3);
+
+	// Main settings, time/date selection, set time, then sweep the hour with the pot
+	begin_scenario();
+	press(1);
+	press(1);
+	press(1);
+	for (uint16_t i = 0; i <= 250; i++) {
+		pot_value = i / 250.0;
+		run_for_ms(POT_POLL_PERIOD_MS);
+	}
+	end_scenario("setting time, pot swept over 250 polls");
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+
+	// The next field only moves the cursor
+	begin_scenario();
+	press(2);
+	end_scenario("hour to minute field");
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+
+	// Through second to confirm, which writes the time to the DS3231
+	begin_scenario();
+	for (uint8_t i = 0; i < 3; i++) {
+		press(2);
+	}
+	run_for_ms(1000);
+	end_scenario("confirm time");
+
+	fprintf(report, "LCD:\n");
+	sim_lcd_render(report);
+	fprintf(report, "backlight level %u\n\n", sim_backlight_level());
+	// Midnight on Monday 5/5/25 in US Eastern is 4:00 UTC, the day of week is written with the date
+	expect(lcd_shows(0, "12:00:0") && lcd_shows(1, "Mon 05/05/25"), "the set time is shown");
+	expect(ds3231_value(DS3231_REGISTER_HOURS) == 4 && ds3231_value(DS3231_REGISTER_DATE) == 5 &&
+		ds3231_value(DS3231_REGISTER_MONTH) == 5 && ds3231_value(DS3231_REGISTER_YEAR) == 25,
+		"the DS3231 holds the set time in UTC");
+	expect(ds3231_value(DS3231_REGISTER_DAY_OF_WEEK) == DateTime_Monday, "the DS3231 day of week matches its date");
+
+	// Night: the backlight fades down to the night level
+	sim_ds3231_set(25, 5, 6, 1, 59, 55);
+	begin_scenario();
+	run_for_ms(10000);
+	end_scenario("night dimming at 22:00, 10 s");
+	fprintf(report, "  backlight level %u\n\n", sim_backlight_level());
+	expect(sim_backlight_level() == BACKLIGHT_NIGHT_LEVEL, "the backlight is at the night level");
+
+	// An alarm at 6:30 brightens the backlight over the 10 minutes before it
+	DateTime alarm_time = {0, 30, 6};
+	alarmclock.alarm = Alarm_New(alarm_time, 1, alarmclock.now, &alarmclock.zone);
+	sim_ds3231_set(25, 5, 6, 10, 19, 59);
+	begin_scenario();
+	run_for_ms(6 * 60000);
+	end_scenario("wake ramp, 6:20 to 6:26");
+	fprintf(report, "  backlight level %u\n\n", sim_backlight_level());
+	expect(sim_backlight_level() > BACKLIGHT_NIGHT_LEVEL && sim_backlight_level() < BACKLIGHT_DAY_LEVEL,
+		"the backlight is ramping up");
+	run_for_ms(4 * 60000);
+
+	// The alarm rings: the backlight flashes until it is turned off with button 2
+	begin_scenario();
+	run_for_ms(5000);
+	press(2);
+	run_for_ms(1000);
+	end_scenario("alarm ringing 5 s, then off");
+	fprintf(report, "  backlight level %u\n\n", sim_backlight_level());
+	expect(alarmclock.alarm.state == ALARM_OFF, "the alarm is off");
+	expect(sim_backlight_level() == BACKLIGHT_DAY_LEVEL, "the backlight stays bright after the alarm");
+
+	// A message longer than the display scrolls by display shift commands, one per step.
+	// It is shown from the main settings menu, which does not redraw on its own.
+	press(1);
+	begin_scenario();
+	LCD_printline_marquee("Error. Restart Device.", 1);
+	run_for_ms(2000);
+	end_scenario("marquee, 2 s");
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+	expect(lcd_shows(1, "Restart Device"), "the message has scrolled");
+	press(3);
+	run_for_ms(100);
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+
+	// DST starts at 2:00 on 3/8/26 (7:00 UTC), the clock goes from 1:59:59 to 3:00:00.
+	// An alarm at 2:30 rings at 3:00, when its time has been skipped.
+	sim_ds3231_set(26, 3, 8, 6, 59, 50);
+	run_for_ms(1000);
+	alarm_time.hour = 2;
+	alarmclock.alarm = Alarm_New(alarm_time, 1, alarmclock.now, &alarmclock.zone);
+	begin_scenario();
+	run_for_ms(15000);
+	end_scenario("DST starts, alarm at 2:30, 15 s");
+	fprintf(report, "  alarm %s\n", alarmclock.alarm.state == ALARM_BEEPING ? "ringing" : "not ringing");
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+	expect(alarmclock.alarm.state == ALARM_BEEPING, "the alarm rings when 2:30 is skipped");
+	expect(lcd_shows(0, "3:00:") && lcd_shows(1, "Sun 03/08/26"), "the clock has gone from 1:59 to 3:00");
+	press(2);
+
+	// DST ends at 2:00 on 11/1/26 (6:00 UTC), the clock goes from 1:59:59 back to 1:00:00.
+	// An alarm at 1:30 rings at the first 1:30 only.
+	sim_ds3231_set(26, 11, 1, 5, 29, 50);
+	run_for_ms(1000);
+	alarm_time.hour = 1;
+	alarmclock.alarm = Alarm_New(alarm_time, 1, alarmclock.now, &alarmclock.zone);
+	begin_scenario();
+	run_for_ms(15000);
+	end_scenario("DST ends, alarm at 1:30, first 1:30, 15 s");
+	fprintf(report, "  alarm %s\n", alarmclock.alarm.state == ALARM_BEEPING ? "ringing" : "not ringing");
+	expect(alarmclock.alarm.state == ALARM_BEEPING, "the alarm rings at the first 1:30");
+	press(2);
+	sim_ds3231_set(26, 11, 1, 6, 29, 50);
+	uint32_t backlight_transactions = sim_bus_stats(sim_backlight.address).transactions;
+	begin_scenario();
+	run_for_ms(15000);
+	end_scenario("DST ends, second 1:30, 15 s");
+	fprintf(report, "  alarm %s\n", alarmclock.alarm.state == ALARM_BEEPING ? "ringing" : "not ringing");
+	sim_lcd_render(report);
+	fprintf(report, "\n");
+	expect(alarmclock.alarm.state != ALARM_BEEPING, "the alarm does not ring at the second 1:30");
+	expect(lcd_shows(0, "1:30:") && lcd_shows(1, "Sun 11/01/26"), "the clock has gone back to 1:00");
+	expect(sim_bus_stats(sim_backlight.address).transactions == backlight_transactions,
+		"the backlight does not change at the second 1:30");
+
+#ifdef TWI_PROFILE
+	// The profiler counts each device in its slot as the bus model counts it
+	fprintf(report, "profiler\n");
+	for (uint8_t slot = 0; slot < TWI_DEVICE_SLOTS; slot++) {
+		uint8_t address = TWI_SlotAddress(slot);
+		const TWI_ProfilerCounters* counters = TWI_Profiler_Get(slot);
+		if (!address || !counters) {
+			continue;
+		}
+		SimBusStats stats = sim_bus_stats(address);
+		fprintf(report, "  0x%02X  %lu txns  %lu bytes  %lu us busy\n", address,
+			(unsigned long)counters->transactions, (unsigned long)counters->bytes, (unsigned long)counters->busy_us);
+		expect(counters->transactions == stats.transactions && counters->bytes == stats.bytes,
+			"the profiler's counts match the bus model's");
+	}
+	fprintf(report, "\n");
+#endif
+	fprintf(report, "LCD instructions sent while busy: %u\n", (unsigned)sim_lcd_busy_violations());
+	expect(sim_lcd_busy_violations() == 0, "no LCD instruction is sent while the controller is busy");
+	if (failures) {
+		fprintf(report, "%u checks failed\n", failures);
+		return 1;
+	}
+	fprintf(report, "All checks passed\n");
+	return 0;
+}
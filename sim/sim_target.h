@@ -0,0 +1,15 @@
+/*
+ * sim_target.h
+ *
+ * Force-included into every target source file in the host build.
+ * Hooks the TWI engine's wait loops up to the simulated bus.
+ */
+
+#ifndef SIM_TARGET_H
+#define SIM_TARGET_H
+
+void sim_wait_hook();
+
+#define TWI_WAIT_HOOK() sim_wait_hook()
+
+#endif // SIM_TARGET_H
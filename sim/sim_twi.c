@@ -0,0 +1,392 @@
+/*
+ * sim_twi.c
+ *
+ * Created: 10/17/2026 3:20:47 PM
+ *  Author: agpri
+ *
+ * Register level model of the TWI0 and TWI1 hosts and the buses they drive, plus
+ * the simulated timers. Writes the engine makes to MADDR, MDATA and MCTRLB are
+ * picked up by sim_twi_step(), played against the device models attached to that
+ * bus, and answered when the bus operation completes by setting MSTATUS and calling
+ * the bus's host interrupt handler. The two buses run concurrently.
+ */
+
+#include "sim.h"
+#include <avr/io.h>
+#include <math.h>
+#include <stddef.h>
+
+TWI_t TWI0 = {.MCTRLB = SIM_REG_EMPTY, .MADDR = SIM_REG_EMPTY, .MDATA = SIM_REG_EMPTY};
+TWI_t TWI1 = {.MCTRLB = SIM_REG_EMPTY, .MADDR = SIM_REG_EMPTY, .MDATA = SIM_REG_EMPTY};
+PORT_t PORTA = {.IN = 0xFF};	// SDA and SCL read back high, released by the pull-ups
+PORT_t PORTF = {.IN = 0xFF};
+VPORT_t VPORTC = {.IN = 0xFF};	// buttons are active low
+static TCB_t tcbs[2];
+
+// Host interrupt handlers from i2c_lib_S25.c. TWI1's only exists with TWI_SEPARATE_BUSES.
+void TWI0_TWIM_vect(void);
+__attribute__((weak)) void TWI1_TWIM_vect(void) {}
+
+typedef struct {
+	TWI_t* twi;
+	void (*interrupt_handler)(void);
+	uint8_t owner;		// the host holds the bus between START and STOP
+	uint8_t reading;	// direction of the current address
+	int8_t target;		// index of the addressed device, -1 if nobody acknowledged
+	uint8_t rx_pending;	// MDATA holds a received byte for the engine
+	uint8_t in_flight;	// a START, byte or STOP is on the bus
+	double done_at_us;	// when it completes
+	uint8_t flags;		// MSTATUS flags it completes with, 0 for no interrupt
+} SimBus;
+
+static SimBus buses[SIM_BUS_COUNT] = {
+	{&TWI0, TWI0_TWIM_vect, 0, 0, -1},
+	{&TWI1, TWI1_TWIM_vect, 0, 0, -1},
+};
+
+uint64_t sim_time_us = 0;
+static double now_us = 0;
+static uint64_t next_tick_us = 1000;
+static uint64_t next_second_us = 1000000;
+static void (*tick_handler)(void) = NULL;
+static void (*second_handler)(void) = NULL;
+static uint8_t in_handler = 0;
+
+static const SimDevice* devices[SIM_MAX_DEVICES];
+static uint8_t device_bus[SIM_MAX_DEVICES];
+static SimBusStats stats[SIM_MAX_DEVICES];
+static SimBusStats unattached_stats;	// traffic to addresses nobody answers
+static uint8_t device_count = 0;
+
+static uint8_t step(double limit_us);
+static uint8_t begin_operation(SimBus* bus);
+static void schedule(SimBus* bus, uint32_t cycles, uint8_t bytes, uint8_t flags);
+static void complete(SimBus* bus);
+static void end_transaction(SimBus* bus);
+static int8_t find_device(SimBus* bus, uint8_t address);
+static void advance_to(double us);
+static void fire_due_handlers();
+
+void sim_bus_attach(uint8_t bus, const SimDevice* device) {
+	if (device_count < SIM_MAX_DEVICES && bus < SIM_BUS_COUNT) {
+		device_bus[device_count] = bus;
+		devices[device_count++] = device;
+	}
+}
+
+void sim_set_tick_handler(void (*handler)(void)) {
+	tick_handler = handler;
+}
+
+void sim_set_second_handler(void (*handler)(void)) {
+	second_handler = handler;
+}
+
+uint8_t sim_twi_step() {
+	return step(INFINITY);
+}
+
+void sim_advance(uint64_t us) {
+	advance_to(now_us + us);
+}
+
+void sim_run_until(uint64_t us) {
+	while (now_us < us) {
+		if (!step(us)) {
+			advance_to((next_tick_us < us) ? next_tick_us : us);
+		}
+	}
+}
+
+void sim_wait_hook() {
+	if (!sim_twi_step()) {
+		advance_to(next_tick_us);
+	}
+}
+
+// Busy-wait delays: the buses keep running meanwhile, except inside an interrupt handler
+void sim_delay_us(double us) {
+	if (in_handler) {
+		now_us += us;
+		sim_time_us = (uint64_t)now_us;
+		return;
+	}
+	sim_run_until((uint64_t)(now_us + us + 0.5));
+}
+
+// A free running TCB counts F_CPU cycles, or half of them with DIV2, since the simulation
+// started. Only the periodic interrupt mode at F_CPU or F_CPU / 2 is modelled.
+TCB_t* sim_tcb(uint8_t n) {
+	TCB_t* tcb = &tcbs[n];
+	if (tcb->CTRLA & TCB_ENABLE_bm) {
+		uint8_t divider = ((tcb->CTRLA & TCB_CLKSEL_gm) == TCB_CLKSEL_DIV2_gc) ? 2 : 1;
+		tcb->CNT = (uint16_t)(uint64_t)(now_us * (SIM_F_CPU / 1e6) / divider);
+	}
+	return tcb;
+}
+
+SimBusStats sim_bus_stats(uint8_t address) {
+	if (address != 0) {
+		for (uint8_t i = 0; i < device_count; i++) {
+			if (devices[i]->address == address) {
+				return stats[i];
+			}
+		}
+		return unattached_stats;
+	}
+
+	SimBusStats total = unattached_stats;
+	for (uint8_t i = 0; i < device_count; i++) {
+		total.transactions += stats[i].transactions;
+		total.bytes += stats[i].bytes;
+		total.cycles += stats[i].cycles;
+		total.busy_us += stats[i].busy_us;
+	}
+	return total;
+}
+
+void sim_bus_snapshot(SimBusStats snapshot[]) {
+	for (uint8_t i = 0; i < SIM_MAX_DEVICES; i++) {
+		snapshot[i] = (i < device_count) ? stats[i] : (SimBusStats) {0};
+	}
+}
+
+void sim_bus_report(FILE* out, const SimBusStats before[], const SimBusStats after[]) {
+	SimBusStats total = {0};
+	fprintf(out, "  %-10s %4s %8s %8s %10s %10s\n", "device", "bus", "txns", "bytes", "cycles", "bus ms");
+	for (uint8_t i = 0; i < device_count; i++) {
+		SimBusStats d = {
+			after[i].transactions - before[i].transactions,
+			after[i].bytes - before[i].bytes,
+			after[i].cycles - before[i].cycles,
+			after[i].busy_us - before[i].busy_us,
+		};
+		total.transactions += d.transactions;
+		total.bytes += d.bytes;
+		total.cycles += d.cycles;
+		total.busy_us += d.busy_us;
+		fprintf(out, "  %-10s %4u %8lu %8lu %10llu %10.2f\n", devices[i]->name, device_bus[i],
+			(unsigned long)d.transactions, (unsigned long)d.bytes,
+			(unsigned long long)d.cycles, d.busy_us / 1000.0);
+	}
+	fprintf(out, "  %-10s %4s %8lu %8lu %10llu %10.2f\n", "total", "",
+		(unsigned long)total.transactions, (unsigned long)total.bytes,
+		(unsigned long long)total.cycles, total.busy_us / 1000.0);
+}
+
+double sim_cycles_to_us(uint8_t bus, uint64_t cycles) {
+	// fSCL = F_CPU / (10 + 2 * MBAUD + F_CPU * tRISE)
+	double period_us = (10.0 + 2.0 * buses[bus].twi->MBAUD) * 1e6 / SIM_F_CPU + SIM_RISE_TIME_NS / 1000.0;
+	return cycles * period_us;
+}
+
+// Starts the pending register writes on idle buses, then completes the earliest
+// bus operation if it finishes by `limit_us`. Returns 0 if nothing happened.
+static uint8_t step(double limit_us) {
+	uint8_t progressed = 0;
+	for (uint8_t i = 0; i < SIM_BUS_COUNT; i++) {
+		while (!buses[i].in_flight && begin_operation(&buses[i])) {
+			progressed = 1;
+		}
+	}
+
+	SimBus* next = NULL;
+	for (uint8_t i = 0; i < SIM_BUS_COUNT; i++) {
+		if (buses[i].in_flight && (!next || buses[i].done_at_us < next->done_at_us)) {
+			next = &buses[i];
+		}
+	}
+	if (!next || next->done_at_us > limit_us) {
+		return progressed;
+	}
+
+	advance_to(next->done_at_us);
+	complete(next);
+	return 1;
+}
+
+// Handles one register write from the engine. Returns 0 if there was none.
+static uint8_t begin_operation(SimBus* bus) {
+	TWI_t* twi = bus->twi;
+
+	if (!(twi->MCTRLA & TWI_ENABLE_bm)) {
+		// Disabled host (bus recovery): pending writes are lost
+		uint8_t pending = (twi->MCTRLB != SIM_REG_EMPTY || twi->MADDR != SIM_REG_EMPTY);
+		twi->MCTRLB = SIM_REG_EMPTY;
+		twi->MADDR = SIM_REG_EMPTY;
+		twi->MDATA = SIM_REG_EMPTY;
+		bus->rx_pending = 0;
+		if (bus->owner) {
+			end_transaction(bus);
+		}
+		return pending;
+	}
+
+	// Commands first: after a read the engine writes MCTRLB and may then write MADDR for the next transaction
+	if (twi->MCTRLB != SIM_REG_EMPTY) {
+		uint8_t command = (uint8_t)twi->MCTRLB;
+		twi->MCTRLB = SIM_REG_EMPTY;
+		if (bus->rx_pending) {
+			bus->rx_pending = 0;
+			twi->MDATA = SIM_REG_EMPTY;
+		}
+
+		if (command & TWI_FLUSH_bm) {
+			end_transaction(bus);
+			return 1;
+		}
+
+		switch (command & TWI_MCMD_gm) {
+			case TWI_MCMD_STOP_gc:
+				if (bus->owner) {
+					schedule(bus, 1, 0, 0);
+					end_transaction(bus);
+				}
+				break;
+			case TWI_MCMD_RECVTRANS_gc:
+				// ACK the previous byte and clock in the next one
+				if (bus->owner && bus->reading && bus->target >= 0) {
+					twi->MDATA = devices[bus->target]->read();
+					bus->rx_pending = 1;
+					schedule(bus, 9, 1, TWI_RIF_bm);
+				}
+				break;
+			default:
+				break;
+		}
+		return 1;
+	}
+
+	if (twi->MADDR != SIM_REG_EMPTY) {
+		uint8_t address_byte = (uint8_t)twi->MADDR;
+		twi->MADDR = SIM_REG_EMPTY;
+
+		// A repeated START ends the previous direction for the addressed device
+		uint8_t repeated = bus->owner;
+		if (repeated && bus->target >= 0) {
+			devices[bus->target]->stop();
+		}
+
+		bus->owner = 1;
+		bus->reading = address_byte & 1;
+		bus->target = find_device(bus, address_byte >> 1);
+		if (!repeated) {
+			if (bus->target >= 0) {
+				stats[bus->target].transactions++;
+			}
+			else {
+				unattached_stats.transactions++;
+			}
+		}
+
+		if (bus->target < 0) {
+			schedule(bus, 1 + 9, 1, TWI_WIF_bm | TWI_RXACK_bm);
+			return 1;
+		}
+
+		devices[bus->target]->start(bus->reading);
+		if (!bus->reading) {
+			schedule(bus, 1 + 9, 1, TWI_WIF_bm);
+		}
+		else {
+			// The first byte is clocked in right after the address
+			twi->MDATA = devices[bus->target]->read();
+			bus->rx_pending = 1;
+			schedule(bus, 1 + 9 + 9, 2, TWI_RIF_bm);
+		}
+		return 1;
+	}
+
+	if (twi->MDATA != SIM_REG_EMPTY && !bus->rx_pending) {
+		uint8_t data = (uint8_t)twi->MDATA;
+		twi->MDATA = SIM_REG_EMPTY;
+		if (bus->owner && !bus->reading && bus->target >= 0) {
+			devices[bus->target]->write(data);
+			schedule(bus, 9, 1, TWI_WIF_bm);
+		}
+		else {
+			schedule(bus, 9, 1, TWI_WIF_bm | TWI_RXACK_bm);
+		}
+		return 1;
+	}
+
+	return 0;
+}
+
+// Puts an operation on the bus and counts its cycles against the addressed device
+static void schedule(SimBus* bus, uint32_t cycles, uint8_t bytes, uint8_t flags) {
+	SimBusStats* s = (bus->target >= 0) ? &stats[bus->target] : &unattached_stats;
+	double us = sim_cycles_to_us(bus - buses, cycles);
+	s->cycles += cycles;
+	s->bytes += bytes;
+	s->busy_us += us;
+	bus->in_flight = 1;
+	bus->done_at_us = now_us + us;
+	bus->flags = flags;
+}
+
+static void complete(SimBus* bus) {
+	TWI_t* twi = bus->twi;
+	bus->in_flight = 0;
+	if (!bus->flags || !(twi->MCTRLA & TWI_ENABLE_bm)) {
+		return;
+	}
+	if (twi->MCTRLB != SIM_REG_EMPTY && (twi->MCTRLB & TWI_FLUSH_bm)) {
+		// Recovered while the byte was on the bus, the engine has moved on
+		return;
+	}
+
+	twi->MSTATUS = bus->flags | TWI_BUSSTATE_OWNER_gc;
+	if (twi->MCTRLA & (TWI_RIEN_bm | TWI_WIEN_bm)) {
+		in_handler = 1;
+		bus->interrupt_handler();
+		in_handler = 0;
+	}
+}
+
+static void end_transaction(SimBus* bus) {
+	if (bus->target >= 0) {
+		devices[bus->target]->stop();
+	}
+	bus->owner = 0;
+	bus->reading = 0;
+	bus->target = -1;
+	bus->twi->MSTATUS = TWI_BUSSTATE_IDLE_gc;
+}
+
+static int8_t find_device(SimBus* bus, uint8_t address) {
+	for (uint8_t i = 0; i < device_count; i++) {
+		if (&buses[device_bus[i]] == bus && devices[i]->address == address) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void advance_to(double us) {
+	if (us > now_us) {
+		now_us = us;
+		sim_time_us = (uint64_t)now_us;
+	}
+	fire_due_handlers();
+}
+
+static void fire_due_handlers() {
+	if (in_handler) {
+		return;
+	}
+	in_handler = 1;
+	while (next_tick_us <= sim_time_us) {
+		if (next_second_us <= next_tick_us) {
+			next_second_us += 1000000;
+			if (second_handler) {
+				second_handler();
+			}
+		}
+		next_tick_us += 1000;
+		if (tick_handler) {
+			tick_handler();
+		}
+	}
+	in_handler = 0;
+}
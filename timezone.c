@@ -0,0 +1,164 @@
+/*
+ * timezone.c
+ *
+ * Created: 10/17/2026 8:05:37 PM
+ *  Author: agpri
+ */
+
+#include "timezone.h"
+#include <avr/pgmspace.h>
+
+#define SECONDS_PER_QUARTER_HOUR 900L
+
+// Interval of a zone without DST, and the next transition when there is none left
+#define NO_TRANSITION 0xFFFFFFFFUL
+
+// Second Sunday of March to first Sunday of November, at 2:00
+#define US_DST { 3, 2, DateTime_Sunday, 2 }, { 11, 1, DateTime_Sunday, 2 }
+// Last Sunday of March to last Sunday of October, at 1:00 UTC
+#define UK_DST { 3, 5, DateTime_Sunday, 1 }, { 10, 5, DateTime_Sunday, 2 }
+#define EU_DST { 3, 5, DateTime_Sunday, 2 }, { 10, 5, DateTime_Sunday, 3 }
+// First Sunday of October to first Sunday of April, over the new year
+#define AU_DST { 10, 1, DateTime_Sunday, 2 }, { 4, 1, DateTime_Sunday, 3 }
+
+static const TimeZone_Rules ZONES[TIMEZONE_COUNT] PROGMEM = {
+	[TIMEZONE_UTC]               = { 0, 0 },
+	[TIMEZONE_US_EASTERN]        = { -20, 4, US_DST },	// EST5EDT
+	[TIMEZONE_US_CENTRAL]        = { -24, 4, US_DST },	// CST6CDT
+	[TIMEZONE_US_MOUNTAIN]       = { -28, 4, US_DST },	// MST7MDT
+	[TIMEZONE_US_ARIZONA]        = { -28, 0 },			// MST7
+	[TIMEZONE_US_PACIFIC]        = { -32, 4, US_DST },	// PST8PDT
+	[TIMEZONE_UK]                = { 0, 4, UK_DST },		// GMT0BST
+	[TIMEZONE_CENTRAL_EUROPE]    = { 4, 4, EU_DST },		// CET-1CEST
+	[TIMEZONE_AUSTRALIA_EASTERN] = { 40, 4, AU_DST },		// AEST-10AEDT
+};
+
+static void refresh(TimeZone *zone, DateTime_Epoch now);
+static DateTime_Epoch transition(const TimeZone_Rule *rule, uint8_t year, int32_t offset);
+static DateTime_Epoch subtract_offset(DateTime_Epoch local, int32_t offset);
+
+TimeZone TimeZone_New(TimeZone_Id id, DateTime_Epoch now) {
+	TimeZone zone = {id, 0, 0, 0};
+	refresh(&zone, now);
+	return zone;
+}
+
+DateTime_Epoch TimeZone_ToLocal(TimeZone *zone, DateTime_Epoch now) {
+	// Unsigned, so a time before the interval is outside it too
+	if (now - zone->since >= zone->span) {
+		refresh(zone, now);
+	}
+	return now + zone->offset;
+}
+
+DateTime_Epoch TimeZone_ToLocalAt(const TimeZone *zone, DateTime_Epoch t) {
+	TimeZone at = *zone;
+	refresh(&at, t);
+	return t + at.offset;
+}
+
+DateTime_Epoch TimeZone_ToUTC(const TimeZone *zone, DateTime_Epoch local) {
+	TimeZone_Rules rules;
+	memcpy_P(&rules, &ZONES[zone->id], sizeof(rules));
+	int32_t standard = rules.offset * SECONDS_PER_QUARTER_HOUR;
+	int32_t daylight = standard + rules.dst * SECONDS_PER_QUARTER_HOUR;
+
+	// Read as daylight time first, the earlier instant when the local time repeats
+	TimeZone at = *zone;
+	DateTime_Epoch t = subtract_offset(local, daylight);
+	refresh(&at, t);
+	if (at.offset == daylight) {
+		return t;
+	}
+	t = subtract_offset(local, standard);
+	refresh(&at, t);
+	if (at.offset == standard) {
+		return t;
+	}
+	// Neither: the local time was skipped, DST started in between
+	return at.since;
+}
+
+DateTime_Epoch TimeZone_NextLocalTime(const TimeZone *zone, DateTime_Epoch now, uint32_t second_of_day) {
+	DateTime_Epoch local = TimeZone_ToLocalAt(zone, now);
+	DateTime_Epoch midnight = local - local % DATETIME_SECONDS_PER_DAY;
+	DateTime_Epoch t = TimeZone_ToUTC(zone, midnight + second_of_day);
+	if (t <= now) {
+		t = TimeZone_ToUTC(zone, midnight + DATETIME_SECONDS_PER_DAY + second_of_day);
+	}
+	return t;
+}
+
+// Evaluate the rules at `now`: the offset, from the last transition to the next one.
+// Those are among the transitions of the year before, this year and the next.
+void refresh(TimeZone *zone, DateTime_Epoch now) {
+	TimeZone_Rules rules;
+	memcpy_P(&rules, &ZONES[zone->id], sizeof(rules));
+	int32_t standard = rules.offset * SECONDS_PER_QUARTER_HOUR;
+	int32_t daylight = standard + rules.dst * SECONDS_PER_QUARTER_HOUR;
+
+	zone->offset = standard;
+	zone->since = 0;
+	DateTime_Epoch next = NO_TRANSITION;
+	if (rules.dst) {
+		uint8_t found = 0;
+		int32_t offset_before_next = standard;
+		uint8_t year = DateTime_FromEpoch(now).year;
+		for (int8_t y = year - 1; y <= year + 1; y++) {
+			if (y < 0 || y > 99) {
+				// The DS3231 only counts 2000-2099
+				continue;
+			}
+			DateTime_Epoch times[2] = {
+				transition(&rules.dst_start, y, standard),
+				transition(&rules.dst_end, y, daylight)
+			};
+			int32_t offsets[2] = {daylight, standard};
+			for (uint8_t i = 0; i < 2; i++) {
+				if (times[i] <= now) {
+					if (!found || times[i] >= zone->since) {
+						zone->since = times[i];
+						zone->offset = offsets[i];
+						found = 1;
+					}
+				}
+				else if (times[i] < next) {
+					next = times[i];
+					offset_before_next = offsets[i] == daylight ? standard : daylight;
+				}
+			}
+		}
+		if (!found) {
+			zone->offset = offset_before_next;
+		}
+	}
+
+	// West of UTC, the first hours of 2000 have no local time; they are shown as UTC.
+	// The DS3231 starts there after losing power, until the time is set.
+	if (zone->offset < 0 && now < (DateTime_Epoch)-zone->offset) {
+		next = -zone->offset;
+		zone->offset = 0;
+	}
+	zone->span = next - zone->since;
+}
+
+// Instant of a rule's transition in a year (00-99), `offset` being the one in force before it
+DateTime_Epoch transition(const TimeZone_Rule *rule, uint8_t year, int32_t offset) {
+	DateTime date = {0, 0, rule->hour, 1, 1, rule->month, year, DateTime_Invalid_Day};
+	DateTime_DayOfWeek first = DateTime_ComputeDayOfWeek(&date);
+	uint8_t day = 1 + (rule->dayOfWeek + 7 - first) % 7 + 7 * (rule->week - 1);
+	if (day > DateTime_DaysInMonth(rule->month, DateTime_IsLeapYear(2000 + year))) {
+		// Week 5 is the last one, whether the month has four or five
+		day -= 7;
+	}
+	date.day = day;
+	return subtract_offset(DateTime_ToEpoch(&date), offset);
+}
+
+// UTC of a local time with an offset, 0 for local times before 2000 in UTC
+DateTime_Epoch subtract_offset(DateTime_Epoch local, int32_t offset) {
+	if (offset > 0 && local < (DateTime_Epoch)offset) {
+		return 0;
+	}
+	return local - offset;
+}
@@ -0,0 +1,76 @@
+/*
+ * timezone.h
+ *
+ * Created: 10/17/2026 8:05:37 PM
+ *  Author: agpri
+ *
+ * Local time from UTC with daylight saving time. Each zone is a standard offset and
+ * a pair of DST rules in a table in flash. A TimeZone caches the offset in force and
+ * the interval it holds for, so converting the current time costs one compare; the
+ * rules are only evaluated when a transition is passed (twice a year), or for other
+ * instants with TimeZone_ToLocalAt and TimeZone_ToUTC.
+ * The instants are UTC seconds since 2000, local times are the same count on the
+ * local wall clock.
+ */
+
+#ifndef TIMEZONE_H
+#define TIMEZONE_H
+
+#include "datetime.h"
+
+// Zones of the rule table
+typedef enum {
+	TIMEZONE_UTC,
+	TIMEZONE_US_EASTERN,
+	TIMEZONE_US_CENTRAL,
+	TIMEZONE_US_MOUNTAIN,
+	TIMEZONE_US_ARIZONA,
+	TIMEZONE_US_PACIFIC,
+	TIMEZONE_UK,
+	TIMEZONE_CENTRAL_EUROPE,
+	TIMEZONE_AUSTRALIA_EASTERN,
+	TIMEZONE_COUNT
+} TimeZone_Id;
+
+// A DST transition, as POSIX TZ writes it (Mm.w.d/hour): the `week`th `dayOfWeek` of
+// `month`, 5 for the last one, at `hour` on the local clock as it reads before the change
+typedef struct {
+	uint8_t month;		// 1-12
+	uint8_t week;		// 1-5
+	uint8_t dayOfWeek;	// DateTime_DayOfWeek
+	uint8_t hour;		// 0-23
+} TimeZone_Rule;
+
+// Offsets are in steps of 15 minutes
+typedef struct {
+	int8_t offset;			// standard time minus UTC
+	uint8_t dst;			// added during DST, 0 if the zone has no DST
+	TimeZone_Rule dst_start;
+	TimeZone_Rule dst_end;
+} TimeZone_Rules;
+
+typedef struct {
+	TimeZone_Id id;
+	int32_t offset;			// local time minus UTC, in seconds, from `since` for `span` seconds
+	DateTime_Epoch since;	// last transition
+	uint32_t span;			// seconds from it to the next transition
+} TimeZone;
+
+// A zone, with the offset in force at `now`
+TimeZone TimeZone_New(TimeZone_Id id, DateTime_Epoch now);
+
+// Local time of the current time. Refreshes the cache if `now` left the interval it
+// holds for, otherwise only compares: call it with the time as it is read.
+DateTime_Epoch TimeZone_ToLocal(TimeZone *zone, DateTime_Epoch now);
+
+// Local time of any instant, evaluating the rules (does not touch the cache)
+DateTime_Epoch TimeZone_ToLocalAt(const TimeZone *zone, DateTime_Epoch t);
+
+// Instant of a local time. A local time repeated when DST ends is taken as the first
+// one; a local time skipped when DST starts gives the instant of the transition.
+DateTime_Epoch TimeZone_ToUTC(const TimeZone *zone, DateTime_Epoch local);
+
+// First instant after `now` at which the local clock reads (or skips past) a time of day
+DateTime_Epoch TimeZone_NextLocalTime(const TimeZone *zone, DateTime_Epoch now, uint32_t second_of_day);
+
+#endif // TIMEZONE_H
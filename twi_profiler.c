@@ -0,0 +1,97 @@
+/*
+ * twi_profiler.c
+ *
+ * Created: 10/17/2026 1:58:40 PM
+ *  Author: agpri
+ */
+
+#include "twi_profiler.h"
+
+#ifdef TWI_PROFILE
+
+#include "i2c_lib_S25.h"
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// TCB0 runs at F_CPU / 2 = 8 MHz
+#define TWI_PROFILER_TICKS_PER_US 8
+
+static TWI_ProfilerCounters counters[TWI_DEVICE_SLOTS];
+static uint16_t start_ticks[TWI_DEVICE_SLOTS];	// per slot, transactions on different buses overlap
+
+void TWI_Profiler_Init() {
+	// Free running 16-bit counter
+	TCB0.CCMP = 0xFFFF;
+	TCB0.CTRLB = TCB_CNTMODE_INT_gc;
+	TCB0.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm;
+}
+
+void TWI_Profiler_Start(uint8_t slot) {
+	if (slot < TWI_DEVICE_SLOTS) {
+		start_ticks[slot] = TCB0.CNT;
+	}
+}
+
+void TWI_Profiler_Byte(uint8_t slot) {
+	if (slot < TWI_DEVICE_SLOTS) {
+		counters[slot].bytes++;
+	}
+}
+
+void TWI_Profiler_Stop(uint8_t slot) {
+	uint16_t now = TCB0.CNT;
+	if (slot < TWI_DEVICE_SLOTS) {
+		uint16_t elapsed = now - start_ticks[slot];
+		counters[slot].transactions++;
+		counters[slot].busy_us += elapsed / TWI_PROFILER_TICKS_PER_US;
+	}
+}
+
+const TWI_ProfilerCounters* TWI_Profiler_Get(uint8_t slot) {
+	if (slot < TWI_DEVICE_SLOTS && counters[slot].transactions > 0) {
+		return &counters[slot];
+	}
+	return NULL;
+}
+
+void TWI_Profiler_Dump() {
+	TWI_ProfilerCounters copy[TWI_DEVICE_SLOTS];
+	TWI_ErrorCounters errors[TWI_DEVICE_SLOTS];
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for (uint8_t i = 0; i < TWI_DEVICE_SLOTS; i++) {
+			copy[i] = counters[i];
+			const TWI_ErrorCounters* e = TWI_GetErrorCounters(TWI_SlotAddress(i));
+			errors[i] = e ? *e : (TWI_ErrorCounters) {0};
+		}
+	}
+
+	printf("addr  txns      bytes     nack  arb   buserr timeout busy_us\n");
+	for (uint8_t i = 0; i < TWI_DEVICE_SLOTS; i++) {
+		TWI_ProfilerCounters* c = &copy[i];
+		TWI_ErrorCounters* e = &errors[i];
+		if (c->transactions == 0) {
+			continue;
+		}
+		printf("0x%02X  %-9lu %-9lu %-5u %-5u %-6u %-7u %lu\n",
+			e->address,
+			(unsigned long)c->transactions,
+			(unsigned long)c->bytes,
+			e->nacks,
+			e->arbitration_lost,
+			e->bus_errors,
+			e->timeouts,
+			(unsigned long)c->busy_us);
+	}
+}
+
+void TWI_Profiler_Reset() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for (uint8_t i = 0; i < TWI_DEVICE_SLOTS; i++) {
+			counters[i] = (TWI_ProfilerCounters) {0};
+		}
+	}
+}
+
+#endif // TWI_PROFILE
@@ -0,0 +1,62 @@
+/*
+ * twi_profiler.h
+ *
+ * Created: 10/17/2026 1:47:22 PM
+ *  Author: agpri
+ *
+ * Per device I2C traffic counters, to see how the bus time splits between the RTC
+ * and the LCD. Only compiled in when TWI_PROFILE is defined; otherwise the hooks
+ * used by the TWI engine expand to nothing. The counters are indexed by the device's
+ * slot in the TWI engine (see TWI_SlotAddress), errors are counted there.
+ *
+ * Busy time is measured with TCB0 counting at F_CPU / 2, so a single transaction
+ * must finish within 8 ms (65536 ticks) to be timed correctly.
+ */
+
+#ifndef TWI_PROFILER_H
+#define TWI_PROFILER_H
+
+#include <stdint.h>
+
+#ifdef TWI_PROFILE
+
+typedef struct {
+	uint32_t transactions;
+	uint32_t bytes;		// address and data bytes, in both directions
+	uint32_t busy_us;	// time from START to STOP
+} TWI_ProfilerCounters;
+
+// Start the timer used to measure busy time
+void TWI_Profiler_Init();
+
+// A transaction to the device in `slot` is starting.
+// The hooks ignore a slot of TWI_DEVICE_SLOTS, given when all slots are taken.
+void TWI_Profiler_Start(uint8_t slot);
+
+// One address or data byte went over the bus
+void TWI_Profiler_Byte(uint8_t slot);
+
+// The transaction released the bus
+void TWI_Profiler_Stop(uint8_t slot);
+
+// Returns the counters of a device slot, or NULL if it has not had a transaction
+const TWI_ProfilerCounters* TWI_Profiler_Get(uint8_t slot);
+
+// Print all counters, with the engine's error counters, to stdout (the UART)
+void TWI_Profiler_Dump();
+
+// Clear all counters
+void TWI_Profiler_Reset();
+
+#else
+
+#define TWI_Profiler_Init()
+#define TWI_Profiler_Start(slot)
+#define TWI_Profiler_Byte(slot)
+#define TWI_Profiler_Stop(slot)
+#define TWI_Profiler_Dump()
+#define TWI_Profiler_Reset()
+
+#endif // TWI_PROFILE
+
+#endif // TWI_PROFILER_H
@@ -0,0 +1,131 @@
+/*
+ * twi_scheduler.c
+ *
+ * Created: 10/17/2026 10:31:05 AM
+ *  Author: agpri
+ */
+
+#include "twi_scheduler.h"
+#include "i2c_lib_S25.h"
+#include <stddef.h>
+
+static TWI_DeviceBudget* find_device(TWI_Scheduler* scheduler, uint8_t address);
+static TWI_TransactionQueue* queue_of(TWI_Scheduler* scheduler, const TWI_Transaction* t);
+static uint16_t wire_bytes(const TWI_Transaction* t);
+static uint32_t budget_cap(const TWI_DeviceBudget* device);
+
+void TWI_Scheduler_AddDevice(TWI_Scheduler* scheduler, uint8_t address, TWI_Priority priority, uint16_t bytes_per_second) {
+	TWI_DeviceBudget* device = find_device(scheduler, address);
+	if (!device) {
+		if (scheduler->device_count >= TWI_SCHEDULER_MAX_DEVICES) {
+			return;
+		}
+		device = &scheduler->devices[scheduler->device_count++];
+	}
+	device->address = address;
+	device->priority = priority;
+	device->bytes_per_second = bytes_per_second;
+	device->credit = budget_cap(device);
+}
+
+uint8_t TWI_Scheduler_Full(TWI_Scheduler* scheduler, const TWI_Transaction* transaction) {
+	TWI_TransactionQueue* q = queue_of(scheduler, transaction);
+	return q->count >= q->length;
+}
+
+void TWI_Scheduler_Enqueue(TWI_Scheduler* scheduler, const TWI_Transaction* transaction) {
+	TWI_TransactionQueue* q = queue_of(scheduler, transaction);
+	uint8_t tail = (q->head + q->count) % q->length;
+	q->slots[tail] = *transaction;
+	q->count++;
+}
+
+TWI_Transaction* TWI_Scheduler_Next(TWI_Scheduler* scheduler) {
+	for (uint8_t priority = 0; priority < TWI_PRIORITY_COUNT; priority++) {
+		TWI_TransactionQueue* q = &scheduler->queues[priority];
+		if (q->count == 0) {
+			continue;
+		}
+
+		TWI_Transaction* t = &q->slots[q->head];
+		TWI_DeviceBudget* device = find_device(scheduler, t->address);
+		if (device && device->bytes_per_second != TWI_SCHEDULER_UNLIMITED) {
+			uint32_t cost = (uint32_t)wire_bytes(t) * 1000;
+			// A transaction bigger than the whole window may go once the budget is full
+			if (device->credit < cost && device->credit < budget_cap(device)) {
+				// Out of budget, let lower priorities use the bus meanwhile
+				continue;
+			}
+			device->credit = (device->credit > cost) ? device->credit - cost : 0;
+		}
+
+		scheduler->current_queue = q;
+		return t;
+	}
+	return NULL;
+}
+
+void TWI_Scheduler_Complete(TWI_Scheduler* scheduler) {
+	TWI_TransactionQueue* q = scheduler->current_queue;
+	if (!q) {
+		return;
+	}
+	q->head = (q->head + 1) % q->length;
+	q->count--;
+	scheduler->current_queue = NULL;
+}
+
+uint8_t TWI_Scheduler_Empty(TWI_Scheduler* scheduler) {
+	for (uint8_t priority = 0; priority < TWI_PRIORITY_COUNT; priority++) {
+		if (scheduler->queues[priority].count > 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void TWI_Scheduler_Tick(TWI_Scheduler* scheduler) {
+	for (uint8_t i = 0; i < scheduler->device_count; i++) {
+		TWI_DeviceBudget* device = &scheduler->devices[i];
+		if (device->bytes_per_second == TWI_SCHEDULER_UNLIMITED) {
+			continue;
+		}
+		// bytes_per_second thousandths of a byte accrue every millisecond
+		uint32_t cap = budget_cap(device);
+		device->credit += device->bytes_per_second;
+		if (device->credit > cap) {
+			device->credit = cap;
+		}
+	}
+}
+
+static TWI_DeviceBudget* find_device(TWI_Scheduler* scheduler, uint8_t address) {
+	for (uint8_t i = 0; i < scheduler->device_count; i++) {
+		if (scheduler->devices[i].address == address) {
+			return &scheduler->devices[i];
+		}
+	}
+	return NULL;
+}
+
+static TWI_TransactionQueue* queue_of(TWI_Scheduler* scheduler, const TWI_Transaction* t) {
+	TWI_DeviceBudget* device = find_device(scheduler, t->address);
+	return &scheduler->queues[device ? device->priority : TWI_PRIORITY_NORMAL];
+}
+
+// Bytes the transaction puts on the wire, counting the address bytes
+static uint16_t wire_bytes(const TWI_Transaction* t) {
+	uint16_t bytes = 0;
+	uint8_t written = t->header_length + t->write_length;
+	if (written > 0) {
+		bytes += 1 + written;
+	}
+	if (t->read_length > 0) {
+		bytes += 1 + t->read_length;
+	}
+	return bytes;
+}
+
+static uint32_t budget_cap(const TWI_DeviceBudget* device) {
+	return (uint32_t)device->bytes_per_second * TWI_SCHEDULER_BUDGET_WINDOW_MS;
+}
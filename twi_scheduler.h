@@ -0,0 +1,106 @@
+/*
+ * twi_scheduler.h
+ *
+ * Created: 10/17/2026 10:12:40 AM
+ *  Author: agpri
+ *
+ * Orders queued TWI transactions by device priority and keeps each device
+ * within its bus budget. Used by the TWI engine, which asks for the next
+ * transaction each time the bus becomes free, so a long run of LCD writes
+ * can be overtaken by an RTC read between any two transactions.
+ * Each bus has its own scheduler, devices and budgets.
+ */
+
+#ifndef TWI_SCHEDULER_H
+#define TWI_SCHEDULER_H
+
+#include <stdint.h>
+
+struct TWI_Transaction;
+
+typedef enum {
+	TWI_PRIORITY_HIGH,	// timekeeping (DS3231)
+	TWI_PRIORITY_NORMAL,	// display (LCD), and any device that was not added
+	TWI_PRIORITY_LOW,	// backlight
+	TWI_PRIORITY_COUNT,
+} TWI_Priority;
+
+// Number of transactions that can wait in each priority class
+#define TWI_SCHEDULER_HIGH_QUEUE_LENGTH     4
+#define TWI_SCHEDULER_NORMAL_QUEUE_LENGTH   40	// a full two line LCD redraw
+#define TWI_SCHEDULER_LOW_QUEUE_LENGTH      8
+
+// Number of devices that can be added
+#define TWI_SCHEDULER_MAX_DEVICES           4
+
+// Unused budget carries over for at most this long, which bounds the size of a burst
+#define TWI_SCHEDULER_BUDGET_WINDOW_MS      250
+
+// Budget value for devices that may use the bus as much as they want
+#define TWI_SCHEDULER_UNLIMITED             0
+
+#define TWI_SCHEDULER_SLOTS \
+	(TWI_SCHEDULER_HIGH_QUEUE_LENGTH + TWI_SCHEDULER_NORMAL_QUEUE_LENGTH + TWI_SCHEDULER_LOW_QUEUE_LENGTH)
+
+typedef struct {
+	struct TWI_Transaction* slots;
+	uint8_t length;
+	uint8_t head;
+	volatile uint8_t count;
+} TWI_TransactionQueue;
+
+typedef struct {
+	uint8_t address;
+	TWI_Priority priority;
+	uint16_t bytes_per_second;
+	uint32_t credit;	// budget available, in thousandths of a byte
+} TWI_DeviceBudget;
+
+typedef struct {
+	TWI_TransactionQueue queues[TWI_PRIORITY_COUNT];	// indexed by TWI_Priority
+	TWI_DeviceBudget devices[TWI_SCHEDULER_MAX_DEVICES];
+	uint8_t device_count;
+	TWI_TransactionQueue* current_queue;	// queue of the transaction handed out by TWI_Scheduler_Next
+} TWI_Scheduler;
+
+// Static initializer. `slots` is an array of TWI_SCHEDULER_SLOTS transactions, split between the queues.
+#define TWI_SCHEDULER_INITIALIZER(slots) { \
+	.queues = { \
+		{(slots), TWI_SCHEDULER_HIGH_QUEUE_LENGTH, 0, 0}, \
+		{(slots) + TWI_SCHEDULER_HIGH_QUEUE_LENGTH, TWI_SCHEDULER_NORMAL_QUEUE_LENGTH, 0, 0}, \
+		{(slots) + TWI_SCHEDULER_HIGH_QUEUE_LENGTH + TWI_SCHEDULER_NORMAL_QUEUE_LENGTH, TWI_SCHEDULER_LOW_QUEUE_LENGTH, 0, 0}, \
+	}, \
+}
+
+/*
+ * Assign a device its priority class and bus budget.
+ * Arguments:
+ * - scheduler: scheduler of the bus the device is on
+ * - address: 7-bit client address
+ * - priority: class its transactions are queued in
+ * - bytes_per_second: bytes on the wire per second, including address bytes,
+ *   or TWI_SCHEDULER_UNLIMITED
+ */
+void TWI_Scheduler_AddDevice(TWI_Scheduler* scheduler, uint8_t address, TWI_Priority priority, uint16_t bytes_per_second);
+
+// Returns 1 if the queue the transaction belongs to has no free slot.
+uint8_t TWI_Scheduler_Full(TWI_Scheduler* scheduler, const struct TWI_Transaction* transaction);
+
+// Copy a transaction into its priority queue. The queue must not be full.
+void TWI_Scheduler_Enqueue(TWI_Scheduler* scheduler, const struct TWI_Transaction* transaction);
+
+// Returns the transaction to put on the bus next and charges its device's budget,
+// or NULL if nothing is queued or every queued device is out of budget.
+// The transaction stays queued until TWI_Scheduler_Complete is called.
+struct TWI_Transaction* TWI_Scheduler_Next(TWI_Scheduler* scheduler);
+
+// Remove the transaction returned by the last TWI_Scheduler_Next from its queue.
+void TWI_Scheduler_Complete(TWI_Scheduler* scheduler);
+
+// Returns 1 if no transaction is queued.
+uint8_t TWI_Scheduler_Empty(TWI_Scheduler* scheduler);
+
+// Refill the device budgets. Call every 1 ms.
+void TWI_Scheduler_Tick(TWI_Scheduler* scheduler);
+
+#endif // TWI_SCHEDULER_H
@@ -0,0 +1,29 @@
+/*
+ * ui_strings.c
+ *
+ * Created: 10/17/2026 7:31:52 PM
+ *  Author: agpri
+ */
+
+#include "ui_strings.h"
+
+const char UI_MENU_SET_TIME_DATE[] PROGMEM = "1: Set Time/Date";
+const char UI_MENU_SET_ALARM[] PROGMEM = "2: Set Alarm";
+const char UI_MENU_SET_TIME[] PROGMEM = "1: Set Time";
+const char UI_MENU_SET_DATE[] PROGMEM = "2: Set Date";
+const char UI_MENU_ALARM_SET[] PROGMEM = "1: Set Alarm";
+const char UI_MENU_ALARM_CLEAR[] PROGMEM = "2: Clear Alarm";
+
+const char UI_LABEL_SET_TIME[] PROGMEM = "Set Time";
+const char UI_LABEL_CONFIRM_TIME[] PROGMEM = "Confirm Time";
+const char UI_LABEL_SET_DATE[] PROGMEM = "Set Date";
+const char UI_LABEL_CONFIRM_DATE[] PROGMEM = "Confirm Date";
+const char UI_LABEL_SET_ALARM[] PROGMEM = "Set Alarm";
+const char UI_LABEL_CONFIRM_ALARM[] PROGMEM = "Confirm Alarm";
+
+const char UI_NO_ALARM_SET[] PROGMEM = "No Alarm Set";
+const char UI_ALARM[] PROGMEM = "Alarm ";
+const char UI_SNOOZED[] PROGMEM = "Snoozed ";
+const char UI_NO_DATE_SET[] PROGMEM = "No Date Set";
+
+const char UI_ERROR_RESTART[] PROGMEM = "Error. Restart Device.";
@@ -0,0 +1,40 @@
+/*
+ * ui_strings.h
+ *
+ * Created: 10/17/2026 7:31:52 PM
+ *  Author: agpri
+ *
+ * Every string the clock shows, in flash. Each one is stored once, however many
+ * screens use it; print them with the _P functions (LCD_printline_P, Format_String_P).
+ */
+
+#ifndef UI_STRINGS_H
+#define UI_STRINGS_H
+
+#include <avr/pgmspace.h>
+
+// Menus
+extern const char UI_MENU_SET_TIME_DATE[] PROGMEM;
+extern const char UI_MENU_SET_ALARM[] PROGMEM;
+extern const char UI_MENU_SET_TIME[] PROGMEM;
+extern const char UI_MENU_SET_DATE[] PROGMEM;
+extern const char UI_MENU_ALARM_SET[] PROGMEM;
+extern const char UI_MENU_ALARM_CLEAR[] PROGMEM;
+
+// Editor labels
+extern const char UI_LABEL_SET_TIME[] PROGMEM;
+extern const char UI_LABEL_CONFIRM_TIME[] PROGMEM;
+extern const char UI_LABEL_SET_DATE[] PROGMEM;
+extern const char UI_LABEL_CONFIRM_DATE[] PROGMEM;
+extern const char UI_LABEL_SET_ALARM[] PROGMEM;
+extern const char UI_LABEL_CONFIRM_ALARM[] PROGMEM;
+
+// Clock display
+extern const char UI_NO_ALARM_SET[] PROGMEM;
+extern const char UI_ALARM[] PROGMEM;
+extern const char UI_SNOOZED[] PROGMEM;
+extern const char UI_NO_DATE_SET[] PROGMEM;
+
+extern const char UI_ERROR_RESTART[] PROGMEM;
+
+#endif // UI_STRINGS_H